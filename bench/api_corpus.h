@@ -0,0 +1,50 @@
+#ifndef DHT_BENCH_API_CORPUS_H
+#define DHT_BENCH_API_CORPUS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <util.h>
+
+/**
+ * @brief Frames from test/test_api.cpp, plus one of each remaining message type and some malformed ones.
+ */
+inline std::vector<std::vector<uint8_t>> apiCorpus()
+{
+    using namespace std::string_literals;
+    const std::string key =
+        "\x01\x02\x03\x04"s
+        "\x05\x06\x07\x08"s
+        "\x09\x0a\x0b\x0c"s
+        "\x0d\x0e\x0f\x10"s
+        "\x11\x12\x13\x14"s
+        "\x15\x16\x17\x18"s
+        "\x19\x1a\x1b\x1c"s
+        "\x1d\x1e\x1f\x20"s;
+    const std::string value = "This is the value that is to be stored."s;
+    const std::string bigValue(1024, 'v');
+
+    std::vector<std::string> frames{
+        // API DECODE GET
+        "\x00\x24\x02\x8b"s + key,
+        // API DECODE PUT
+        "\x00\x4b\x02\x8a"s + key + "This is the value "s + "that is to be stored."s,
+        // PUT with extended header and a 1 KiB value
+        "\x04\x28\x02\x8a\x00\x10\x03\x00"s + key + bigValue,
+        "\x00\x4b\x02\x8c"s + key + value,
+        "\x00\x24\x02\x8d"s + key,
+        "\x00\x2f\x02\x8e\x00\x00\x00\x00"s + value,
+        "\x00\x24\x02\x8f"s + key,
+        // Malformed: size below header, unknown type, GET with a value
+        "\x00\x02\x02\x8b"s,
+        "\x00\x24\x12\x34"s + key,
+        "\x00\x4b\x02\x8b"s + key + value,
+    };
+
+    std::vector<std::vector<uint8_t>> ret{};
+    for (const auto &frame: frames)
+        ret.push_back(util::convertToBytes(frame));
+    return ret;
+}
+
+#endif //DHT_BENCH_API_CORPUS_H
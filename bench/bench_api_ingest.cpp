@@ -0,0 +1,100 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <asio.hpp>
+#include <api.h>
+#include <util.h>
+#include <constants.h>
+
+/*
+ * Measures how many DHT_GET requests per second one api::Api ingests (accept, read, parse, dispatch, respond),
+ * depending on the number of io threads.
+ *
+ * Usage: bench_api_ingest [SECONDS_PER_RUN] [CLIENTS]
+ */
+
+using namespace std::chrono_literals;
+using asio::ip::tcp;
+
+namespace
+{
+    constexpr size_t pipeline = 16;
+
+    std::vector<uint8_t> makeBatch()
+    {
+        std::vector<uint8_t> batch{};
+        for (size_t i = 0; i < pipeline; ++i) {
+            std::vector<uint8_t> key(32, static_cast<uint8_t>(i));
+            auto bytes = api::Message_KEY(util::constants::DHT_GET, key).m_bytes;
+            batch.insert(batch.end(), bytes.begin(), bytes.end());
+        }
+        return batch;
+    }
+
+    double run(uint64_t threads, uint16_t port, size_t clients, std::chrono::seconds duration)
+    {
+        api::Api server(api::Options{.port= port, .threads= threads});
+        server.on<util::constants::DHT_GET>([](const api::Message_KEY &message_data, auto &) {
+            return api::Message_KEY(util::constants::DHT_FAILURE, message_data.key);
+        });
+
+        std::atomic_bool stop{false};
+        std::atomic<size_t> answered{0};
+        auto batch = makeBatch();
+        size_t responseSize = sizeof(api::MessageHeader::MessageHeaderRaw) + 32;
+
+        std::vector<std::thread> workers{};
+        for (size_t c = 0; c < clients; ++c) {
+            workers.emplace_back([&]() {
+                try {
+                    asio::io_context io{};
+                    tcp::socket socket(io);
+                    socket.connect(tcp::endpoint(asio::ip::make_address("127.0.0.1"), port));
+                    std::vector<uint8_t> responses(responseSize * pipeline);
+                    while (!stop) {
+                        asio::write(socket, asio::buffer(batch));
+                        asio::read(socket, asio::buffer(responses));
+                        answered += pipeline;
+                    }
+                }
+                catch (const std::exception &e) {
+                    std::cerr << e.what() << std::endl;
+                }
+            });
+        }
+
+        auto before = answered.load();
+        auto started = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(duration);
+        auto count = answered.load() - before;
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        stop = true;
+        for (auto &worker: workers)
+            worker.join();
+
+        return static_cast<double>(count) / elapsed;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::chrono::seconds duration(argc > 1 ? std::stol(argv[1]) : 3);
+    size_t clients = argc > 2 ? std::stoul(argv[2]) : 2 * std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::setw(10) << "threads" << std::setw(16) << "requests/s" << std::setw(12) << "speedup" << std::endl;
+
+    double baseline = 0;
+    uint16_t port = 7900;
+    for (uint64_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        auto rate = run(threads, port++, clients, duration);
+        if (threads == 1) baseline = rate;
+        std::cout << std::setw(10) << threads
+                  << std::setw(16) << std::fixed << std::setprecision(0) << rate
+                  << std::setw(12) << std::setprecision(2) << (baseline > 0 ? rate / baseline : 0) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <request.h>
+#include <parser.h>
+#include "api_corpus.h"
+
+/*
+ * Measures how fast frames are validated by api::parser::parse, compared to a full api::Request decode,
+ * over the frames in api_corpus.h.
+ *
+ * Usage: bench_api_parser [ROUNDS]
+ */
+
+namespace
+{
+    struct Result
+    {
+        double messages_per_second;
+        double megabytes_per_second;
+    };
+
+    template<typename F>
+    Result measure(const std::vector<std::vector<uint8_t>> &corpus, size_t rounds, F &&decode)
+    {
+        size_t bytes = 0;
+        size_t accepted = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            for (const auto &frame: corpus) {
+                accepted += decode(frame) ? 1 : 0;
+                bytes += frame.size();
+            }
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        // Keeps the loop from being optimized away.
+        if (accepted == 0)
+            std::cerr << "no frame accepted" << std::endl;
+        return {
+            static_cast<double>(rounds * corpus.size()) / elapsed,
+            static_cast<double>(bytes) / elapsed / 1e6
+        };
+    }
+
+    void print(const std::string &name, const Result &result)
+    {
+        std::cout << std::setw(10) << name
+                  << std::setw(16) << std::fixed << std::setprecision(0) << result.messages_per_second
+                  << std::setw(12) << std::setprecision(1) << result.megabytes_per_second << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t rounds = argc > 1 ? std::stoul(argv[1]) : 200000;
+    auto corpus = apiCorpus();
+
+    auto parsed = measure(corpus, rounds, [](const std::vector<uint8_t> &frame) {
+        api::parser::Frame decoded{};
+        return api::parser::parse(frame, decoded) == api::parser::Status::OK;
+    });
+
+    auto requests = measure(corpus, rounds, [](const std::vector<uint8_t> &frame) {
+        try {
+            // What the connection does: validate the frame, then copy key and value out into a request.
+            api::parser::Frame decoded{};
+            if (api::parser::parse(frame, decoded) != api::parser::Status::OK)
+                return false;
+            api::Request request(decoded);
+            return true;
+        }
+        catch (const std::exception &) {
+            return false;
+        }
+    });
+
+    std::cout << std::setw(10) << "decoder" << std::setw(16) << "messages/s" << std::setw(12) << "MB/s" << std::endl;
+    print("parser", parsed);
+    print("request", requests);
+    return 0;
+}
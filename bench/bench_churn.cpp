@@ -0,0 +1,247 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <array>
+#include <optional>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <util.h>
+#include <FingerScheduler.h>
+#include "ring.h"
+
+/*
+ * Simulates a converged ring in which a fraction of the nodes fails at once, then runs maintenance rounds
+ * (checkPredecessor, stabilize and one finger lookup per node and round) until every lookup succeeds again.
+ * Compares a single successor, where a dead successor is only replaced once its finger is looked up again, to a
+ * successor list, where stabilize switches to the next live entry.
+ *
+ * Prints the fraction of failed lookups after some rounds, and the first round in which all lookups succeeded.
+ *
+ * Usage: bench_churn [NODES] [FAILED_PERCENT] [SUCCESSORS]
+ */
+
+namespace
+{
+    constexpr size_t max_rounds = 1000;
+    constexpr size_t lookups_per_round = 2000;
+    constexpr size_t max_hops = 64;
+
+    struct SimNode
+    {
+        util::uint256 id;
+        bool alive{true};
+        std::array<std::optional<size_t>, NodeInformation::key_bits> fingers{};
+        std::vector<size_t> successors{};
+        std::optional<size_t> predecessor{};
+        size_t nextFinger{0};
+    };
+
+    class Simulation
+    {
+    public:
+        Simulation(bench::Ring &ring, size_t successorListSize) : m_ring(ring), m_successorListSize(successorListSize)
+        {
+            auto size = ring.size();
+            m_nodes.resize(size);
+            for (size_t n = 0; n < size; ++n) {
+                auto &node = m_nodes[n];
+                node.id = util::uint256(ring.ids()[n]);
+                for (size_t i = 0; i < NodeInformation::key_bits; ++i)
+                    node.fingers[i] = ring.successorIndex((node.id + util::uint256::pow2(i)).bytes());
+                for (size_t i = 1; i <= successorListSize && i < size; ++i)
+                    node.successors.push_back((n + i) % size);
+                node.predecessor = (n + size - 1) % size;
+            }
+        }
+
+        void fail(double fraction)
+        {
+            std::vector<size_t> indices(m_nodes.size());
+            std::iota(indices.begin(), indices.end(), 0);
+            std::shuffle(indices.begin(), indices.end(), m_ring.random());
+            for (size_t i = 0; i < static_cast<size_t>(fraction * static_cast<double>(m_nodes.size())); ++i)
+                m_nodes[indices[i]].alive = false;
+        }
+
+        void round()
+        {
+            std::vector<size_t> order{};
+            for (size_t n = 0; n < m_nodes.size(); ++n)
+                if (m_nodes[n].alive) order.push_back(n);
+            std::shuffle(order.begin(), order.end(), m_ring.random());
+            for (auto n: order) {
+                checkPredecessor(n);
+                stabilize(n);
+                fixFinger(n);
+            }
+        }
+
+        /**
+         * @return Fraction of lookups from random live nodes for random keys that fail or return a wrong node.
+         */
+        double failureRate()
+        {
+            std::vector<size_t> live{};
+            for (size_t n = 0; n < m_nodes.size(); ++n)
+                if (m_nodes[n].alive) live.push_back(n);
+            std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+            size_t failed = 0;
+            for (size_t i = 0; i < lookups_per_round; ++i) {
+                auto key = util::uint256(bench::randomId(m_ring.random()));
+                auto result = lookup(live[pick(m_ring.random())], key);
+                if (!result || *result != liveSuccessor(key))
+                    ++failed;
+            }
+            return static_cast<double>(failed) / static_cast<double>(lookups_per_round);
+        }
+
+    private:
+        [[nodiscard]] std::optional<size_t> successorOf(size_t n) const
+        {
+            for (const auto &finger: m_nodes[n].fingers)
+                if (finger) return finger;
+            return {};
+        }
+
+        [[nodiscard]] size_t liveSuccessor(const util::uint256 &key) const
+        {
+            auto n = m_ring.successorIndex(key.bytes());
+            while (!m_nodes[n].alive)
+                n = (n + 1) % m_nodes.size();
+            return n;
+        }
+
+        /**
+         * @brief Greedy Chord lookup. Dead fingers are skipped, as after a timed out RPC.
+         */
+        [[nodiscard]] std::optional<size_t> lookup(size_t from, const util::uint256 &key) const
+        {
+            auto current = from;
+            for (size_t hop = 0; hop < max_hops; ++hop) {
+                auto successor = successorOf(current);
+                if (!successor)
+                    return {};
+                if (util::is_in_range_loop(key, m_nodes[current].id, m_nodes[*successor].id, false, true))
+                    return m_nodes[*successor].alive ? successor : std::optional<size_t>{};
+
+                std::optional<size_t> next{};
+                for (size_t i = NodeInformation::key_bits; i-- > 0;) {
+                    auto finger = m_nodes[current].fingers[i];
+                    if (finger && m_nodes[*finger].alive &&
+                        util::is_in_range_loop(m_nodes[*finger].id, m_nodes[current].id, key, false, false)) {
+                        next = finger;
+                        break;
+                    }
+                }
+                if (!next)
+                    return {};
+                current = *next;
+            }
+            return {};
+        }
+
+        void checkPredecessor(size_t n)
+        {
+            auto &node = m_nodes[n];
+            if (node.predecessor && !m_nodes[*node.predecessor].alive)
+                node.predecessor.reset();
+        }
+
+        void removePeer(size_t n, size_t failed)
+        {
+            auto &node = m_nodes[n];
+            bool wasSuccessor = node.fingers[0] == failed;
+            for (auto &finger: node.fingers)
+                if (finger == failed) finger.reset();
+            std::erase(node.successors, failed);
+            if (wasSuccessor && !node.successors.empty())
+                node.fingers[0] = node.successors.front();
+        }
+
+        void stabilize(size_t n)
+        {
+            auto &node = m_nodes[n];
+            auto successor = successorOf(n);
+            // With a successor list, every dead successor costs one failed RPC and is replaced right away.
+            while (m_successorListSize > 0 && successor && !m_nodes[*successor].alive) {
+                removePeer(n, *successor);
+                successor = successorOf(n);
+            }
+            if (!successor || !m_nodes[*successor].alive)
+                return;
+
+            auto predOfSuccessor = m_nodes[*successor].predecessor;
+            if (predOfSuccessor && *predOfSuccessor != n &&
+                util::is_in_range_loop(m_nodes[*predOfSuccessor].id, node.id, m_nodes[*successor].id, false, false)) {
+                node.fingers[0] = predOfSuccessor;
+                successor = predOfSuccessor;
+                if (!m_nodes[*successor].alive)
+                    return;
+            }
+
+            if (m_successorListSize > 0) {
+                node.successors = {*successor};
+                for (auto next: m_nodes[*successor].successors) {
+                    if (node.successors.size() >= m_successorListSize || next == n)
+                        break;
+                    node.successors.push_back(next);
+                }
+            }
+
+            auto &pred = m_nodes[*successor].predecessor;
+            if (!pred || util::is_in_range_loop(node.id, m_nodes[*pred].id, m_nodes[*successor].id, false, false))
+                pred = n;
+        }
+
+        void fixFinger(size_t n)
+        {
+            auto &node = m_nodes[n];
+            auto index = node.nextFinger;
+            auto result = lookup(n, node.id + util::uint256::pow2(index));
+            auto last = index;
+            if (result)
+                last = dht::FingerScheduler::lastCovered(index, m_nodes[*result].id - node.id);
+            for (auto i = index; i <= last; ++i)
+                node.fingers[i] = result;
+            node.nextFinger = (last + 1) % NodeInformation::key_bits;
+        }
+
+        bench::Ring &m_ring;
+        const size_t m_successorListSize;
+        std::vector<SimNode> m_nodes{};
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nodes = argc > 1 ? std::stoul(argv[1]) : 1000;
+    double failed = argc > 2 ? std::stod(argv[2]) / 100.0 : 0.2;
+    size_t successors = argc > 3 ? std::stoul(argv[3]) : 8;
+
+    std::cout << nodes << " nodes, " << failed * 100 << "% fail at once" << std::endl << std::endl
+              << std::setw(14) << "successors" << std::setw(12) << "round 0" << std::setw(12) << "round 1"
+              << std::setw(12) << "round 5" << std::setw(12) << "round 20" << std::setw(16) << "repaired after"
+              << std::endl;
+
+    for (auto listSize: {size_t{0}, successors}) {
+        bench::Ring ring(nodes, 1);
+        Simulation simulation(ring, listSize);
+        simulation.fail(failed);
+
+        std::cout << std::setw(14) << (listSize == 0 ? std::string("single") : std::to_string(listSize))
+                  << std::fixed << std::setprecision(3);
+        std::optional<size_t> repaired{};
+        for (size_t round = 0; round <= max_rounds && (round <= 20 || !repaired); ++round) {
+            auto rate = simulation.failureRate();
+            if (round == 0 || round == 1 || round == 5 || round == 20)
+                std::cout << std::setw(12) << rate;
+            if (rate == 0.0 && !repaired)
+                repaired = round;
+            simulation.round();
+        }
+        std::cout << std::setw(16) << (repaired ? std::to_string(*repaired) + " rounds" : "never") << std::endl;
+    }
+    return 0;
+}
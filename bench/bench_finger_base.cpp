@@ -0,0 +1,111 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <optional>
+#include <random>
+#include <string>
+#include <NodeInformation.h>
+#include <FingerScheduler.h>
+#include "ring.h"
+
+/*
+ * Measures the mean number of hops of lookups in simulated, converged rings of several sizes, for finger tables of
+ * several bases. Base b adds the digit fingers of FingerScheduler::digitOffsets to the binary fingers, which takes
+ * about log_b(N) hops for (b-1) log_b(N) distinct fingers.
+ *
+ * Usage: bench_finger_base [LOOKUPS]
+ */
+
+namespace
+{
+    class Simulation
+    {
+    public:
+        Simulation(bench::Ring &ring, size_t base)
+            : m_ring(ring), m_offsets(dht::FingerScheduler::digitOffsets(base)), m_routing(ring.size()) {}
+
+        size_t hops(size_t origin, const util::uint256 &key)
+        {
+            size_t hops = 0;
+            auto current = origin;
+            while (true) {
+                const auto &routing = routingTable(current);
+                if (util::is_in_range_loop(key, routing.predecessor->getKey(), routing.self, false, true))
+                    return hops;
+                if (util::is_in_range_loop(key, routing.self, routing.successor->getKey(), false, true))
+                    return hops + 1;
+                current = index(*routing.closestPreceding(key));
+                ++hops;
+            }
+        }
+
+        /**
+         * @return Mean number of distinct fingers, binary and digit, over the nodes that routed
+         */
+        [[nodiscard]] double tableSize() const
+        {
+            size_t total = 0, tables = 0;
+            for (const auto &routing: m_routing) {
+                if (routing) {
+                    total += routing->distinct.size();
+                    ++tables;
+                }
+            }
+            return static_cast<double>(total) / static_cast<double>(tables);
+        }
+
+    private:
+        const NodeInformation::RoutingTable &routingTable(size_t n)
+        {
+            if (m_routing[n])
+                return *m_routing[n];
+
+            auto routing = m_ring.routingTable(n);
+            for (const auto &offset: m_offsets)
+                routing.digitFingers.push_back(routing.intern(
+                    m_ring.node(m_ring.successorIndex((routing.self + offset).bytes()))));
+            routing.rebuild();
+            m_routing[n] = std::move(routing);
+            return *m_routing[n];
+        }
+
+        [[nodiscard]] size_t index(const NodeInformation::Node &node) const
+        {
+            return m_ring.successorIndex(node.getId());
+        }
+
+        bench::Ring &m_ring;
+        const std::vector<util::uint256> m_offsets;
+        std::vector<std::optional<NodeInformation::RoutingTable>> m_routing;
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    size_t lookups = argc > 1 ? std::stoul(argv[1]) : 5000;
+
+    std::cout << lookups << " lookups per ring, mean hops (mean distinct fingers)" << std::endl << std::endl
+              << std::setw(8) << "nodes";
+    for (size_t base: {2ul, 4ul, 16ul})
+        std::cout << std::setw(17) << "base " + std::to_string(base);
+    std::cout << std::endl;
+
+    for (size_t nodes: {100ul, 1000ul, 10000ul}) {
+        std::cout << std::setw(8) << nodes;
+        for (size_t base: {2ul, 4ul, 16ul}) {
+            // Same ring and lookups for every base.
+            bench::Ring ring(nodes);
+            Simulation simulation(ring, base);
+            std::uniform_int_distribution<size_t> pick(0, nodes - 1);
+
+            size_t hops = 0;
+            for (size_t i = 0; i < lookups; ++i)
+                hops += simulation.hops(pick(ring.random()), util::uint256(bench::randomId(ring.random())));
+            std::cout << std::fixed << std::setprecision(2) << std::setw(8)
+                      << static_cast<double>(hops) / static_cast<double>(lookups)
+                      << " (" << std::setprecision(0) << std::setw(6) << simulation.tableSize() << ")";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
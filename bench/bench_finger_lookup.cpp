@@ -0,0 +1,76 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <NodeInformation.h>
+#include "ring.h"
+
+/*
+ * Compares the closest preceding finger lookup by binary search over the distinct fingers,
+ * to scanning all fingers from the top, in converged rings of different sizes.
+ *
+ * Usage: bench_finger_lookup [QUERIES]
+ */
+
+namespace
+{
+    /// The lookup as it was before the distinct fingers were kept.
+    NodeInformation::node_handle scan(const NodeInformation::RoutingTable &routing, const util::uint256 &id)
+    {
+        for (size_t i = NodeInformation::key_bits; i >= 1; --i) {
+            if (routing.fingers[i - 1] && util::is_in_range_loop(routing.fingerIds[i - 1], routing.self, id, false, false))
+                return routing.fingers[i - 1];
+        }
+        return {};
+    }
+
+    template<typename F>
+    double nsPerQuery(const std::vector<util::uint256> &queries, size_t rounds, F &&lookup)
+    {
+        size_t found = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r)
+            for (const auto &id: queries)
+                found += lookup(id) ? 1 : 0;
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+        // Keeps the loop from being optimized away.
+        if (found == 0)
+            std::cerr << "nothing found" << std::endl;
+        return elapsed / static_cast<double>(rounds * queries.size());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t totalQueries = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::cout << std::setw(10) << "nodes" << std::setw(10) << "distinct"
+              << std::setw(12) << "scan [ns]" << std::setw(14) << "search [ns]" << std::setw(10) << "speedup"
+              << std::endl;
+
+    for (size_t size: {8ul, 64ul, 512ul, 4096ul, 32768ul, 100000ul}) {
+        bench::Ring ring(size);
+        auto routing = ring.routingTable(0);
+
+        std::vector<util::uint256> queries(4096);
+        for (auto &id: queries)
+            id = util::uint256(bench::randomId(ring.random()));
+        for (const auto &id: queries) {
+            if (scan(routing, id) != routing.closestPreceding(id)) {
+                std::cerr << "lookups disagree for ring size " << size << std::endl;
+                return 1;
+            }
+        }
+
+        size_t rounds = std::max<size_t>(1, totalQueries / queries.size());
+        auto scanned = nsPerQuery(queries, rounds, [&](const auto &id) { return scan(routing, id); });
+        auto searched = nsPerQuery(queries, rounds, [&](const auto &id) { return routing.closestPreceding(id); });
+
+        std::cout << std::setw(10) << size << std::setw(10) << routing.distinct.size()
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << scanned << std::setw(14) << searched
+                  << std::setw(10) << std::setprecision(2) << scanned / searched << std::endl;
+    }
+    return 0;
+}
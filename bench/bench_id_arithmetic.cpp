@@ -0,0 +1,85 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <string>
+#include <util.h>
+#include "ring.h"
+
+/*
+ * Compares ring id arithmetic on 32 byte arrays to util::uint256: range checks as done for every routing
+ * decision, and finger start computation (id + 2^i) as done by fixFingers.
+ *
+ * Usage: bench_id_arithmetic [OPERATIONS]
+ */
+
+namespace
+{
+    template<typename F>
+    double nsPerOperation(size_t operations, F &&operation)
+    {
+        size_t sink = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < operations; ++i)
+            sink += operation(i);
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+        // Keeps the loop from being optimized away.
+        if (sink == 42)
+            std::cerr << "" << std::flush;
+        return elapsed / static_cast<double>(operations);
+    }
+
+    void print(const std::string &name, double bytes, double words)
+    {
+        std::cout << std::setw(16) << name << std::fixed << std::setprecision(2)
+                  << std::setw(12) << bytes << std::setw(12) << words
+                  << std::setw(10) << bytes / words << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t operations = argc > 1 ? std::stoul(argv[1]) : 20000000;
+
+    std::mt19937_64 random(1);
+    constexpr size_t count = 1024;
+    std::vector<bench::id_type> ids(count);
+    std::vector<util::uint256> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        ids[i] = bench::randomId(random);
+        keys[i] = util::uint256(ids[i]);
+    }
+
+    std::cout << std::setw(16) << "operation" << std::setw(12) << "bytes [ns]" << std::setw(12) << "words [ns]"
+              << std::setw(10) << "speedup" << std::endl;
+
+    print("range check",
+          nsPerOperation(operations, [&](size_t i) {
+              return util::is_in_range_loop(ids[i % count], ids[(i + 1) % count], ids[(i + 2) % count], false, true) ? 1u : 0u;
+          }),
+          nsPerOperation(operations, [&](size_t i) {
+              return util::is_in_range_loop(keys[i % count], keys[(i + 1) % count], keys[(i + 2) % count], false, true) ? 1u : 0u;
+          }));
+
+    print("finger start",
+          nsPerOperation(operations, [&](size_t i) {
+              auto start = ids[i % count] + util::pow2<uint8_t, NodeInformation::key_bits / 8>(i % NodeInformation::key_bits);
+              return static_cast<size_t>(start[i % start.size()]);
+          }),
+          nsPerOperation(operations, [&](size_t i) {
+              auto start = keys[i % count] + util::uint256::pow2(i % NodeInformation::key_bits);
+              return static_cast<size_t>(start.words[i % start.words.size()]);
+          }));
+
+    print("distance",
+          nsPerOperation(operations, [&](size_t i) {
+              auto distance = ids[i % count] - ids[(i + 1) % count];
+              return static_cast<size_t>(distance[i % distance.size()]);
+          }),
+          nsPerOperation(operations, [&](size_t i) {
+              auto distance = keys[i % count] - keys[(i + 1) % count];
+              return static_cast<size_t>(distance.words[i % distance.words.size()]);
+          }));
+    return 0;
+}
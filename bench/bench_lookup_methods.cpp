@@ -0,0 +1,126 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <optional>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <NodeInformation.h>
+#include "ring.h"
+
+/*
+ * Compares the lookup methods of PeerImpl in a simulated, converged ring in which every pair of nodes has a fixed
+ * one-way delay. Every lookup takes the same path through the ring in all methods, they differ in who talks to whom:
+ *
+ *   LOCAL    the originator asks every hop itself, then verifies the successor: 2 delays per hop, plus 2.
+ *   PASS_ON  every hop asks the next one and relays the answer back: 2 delays per hop.
+ *   DIRECT   every hop hands the lookup on, the responsible node answers the originator: 1 delay per hop, plus 1.
+ *
+ * Liveness checks of the successor are left out, the failure detector answers them from its cache.
+ *
+ * Usage: bench_lookup_methods [NODES] [LOOKUPS]
+ */
+
+namespace
+{
+    class Simulation
+    {
+    public:
+        explicit Simulation(bench::Ring &ring) : m_ring(ring), m_routing(ring.size()) {}
+
+        /**
+         * @return Nodes the lookup of key from origin visits, origin first, and the node responsible for key
+         */
+        std::pair<std::vector<size_t>, size_t> route(size_t origin, const util::uint256 &key)
+        {
+            std::vector<size_t> path{origin};
+            while (true) {
+                auto current = path.back();
+                const auto &routing = routingTable(current);
+                if (util::is_in_range_loop(key, routing.predecessor->getKey(), routing.self, false, true))
+                    return {path, current};
+                if (util::is_in_range_loop(key, routing.self, routing.successor->getKey(), false, true))
+                    return {path, index(*routing.successor)};
+                path.push_back(index(*routing.closestPreceding(key)));
+            }
+        }
+
+    private:
+        const NodeInformation::RoutingTable &routingTable(size_t n)
+        {
+            if (!m_routing[n])
+                m_routing[n] = m_ring.routingTable(n);
+            return *m_routing[n];
+        }
+
+        [[nodiscard]] size_t index(const NodeInformation::Node &node) const
+        {
+            return m_ring.successorIndex(node.getId());
+        }
+
+        bench::Ring &m_ring;
+        std::vector<std::optional<NodeInformation::RoutingTable>> m_routing;
+    };
+
+    struct Result
+    {
+        std::vector<double> delays{};
+        size_t messages{0};
+    };
+
+    void print(const std::string &method, Result &result, double hops)
+    {
+        auto lookups = static_cast<double>(result.delays.size());
+        std::sort(result.delays.begin(), result.delays.end());
+        auto mean = std::accumulate(result.delays.begin(), result.delays.end(), 0.0) / lookups;
+        auto p99 = result.delays[static_cast<size_t>(0.99 * (lookups - 1))];
+        std::cout << std::setw(10) << method << std::fixed << std::setprecision(2)
+                  << std::setw(8) << hops
+                  << std::setprecision(1) << std::setw(12) << mean << std::setw(12) << p99
+                  << std::setprecision(2) << std::setw(12) << static_cast<double>(result.messages) / lookups
+                  << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nodes = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t lookups = argc > 2 ? std::stoul(argv[2]) : 20000;
+
+    bench::Ring ring(nodes);
+    bench::Latencies latency(nodes, ring.random());
+    Simulation simulation(ring);
+    std::uniform_int_distribution<size_t> pick(0, nodes - 1);
+
+    Result local{}, passOn{}, direct{};
+    size_t totalHops = 0;
+    for (size_t i = 0; i < lookups; ++i) {
+        auto origin = pick(ring.random());
+        auto [path, responsible] = simulation.route(origin, util::uint256(bench::randomId(ring.random())));
+        auto hops = path.size() - 1;
+        totalHops += hops;
+
+        double iterative = 0.0, recursive = 0.0;
+        for (size_t h = 1; h < path.size(); ++h) {
+            iterative += 2 * latency(origin, path[h]);
+            recursive += latency(path[h - 1], path[h]);
+        }
+        // A lookup the originator answers from its own table costs nothing in any method.
+        local.delays.push_back(hops > 0 ? iterative + 2 * latency(origin, responsible) : 0.0);
+        local.messages += hops > 0 ? 2 * (hops + 1) : 0;
+        passOn.delays.push_back(2 * recursive);
+        passOn.messages += 2 * hops;
+        direct.delays.push_back(hops > 0 ? recursive + latency(path.back(), origin) : 0.0);
+        direct.messages += hops > 0 ? 2 * hops + 1 : 0;
+    }
+
+    auto hops = static_cast<double>(totalHops) / static_cast<double>(lookups);
+    std::cout << nodes << " nodes, " << lookups << " lookups, one-way delays of 2ms to 143ms" << std::endl << std::endl
+              << std::setw(10) << "method" << std::setw(8) << "hops" << std::setw(12) << "mean [ms]"
+              << std::setw(12) << "p99 [ms]" << std::setw(12) << "messages" << std::endl;
+    print("LOCAL", local, hops);
+    print("PASS_ON", passOn, hops);
+    print("DIRECT", direct, hops);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <optional>
+#include <random>
+#include <string>
+#include <NodeInformation.h>
+#include "ring.h"
+
+/*
+ * Measures how nodes learned from lookups shorten later lookups, in a simulated, converged ring. Every node routes
+ * by its fingers and the last CAPACITY nodes its own lookups met, as NodeInformation::learnNodes keeps them;
+ * capacity 0 is plain Chord.
+ *
+ * Keys are either uniformly random or drawn from a small set of hot keys.
+ *
+ * Usage: bench_neighbor_cache [NODES] [LOOKUPS]
+ */
+
+namespace
+{
+    class Simulation
+    {
+    public:
+        Simulation(bench::Ring &ring, size_t capacity) : m_ring(ring), m_capacity(capacity), m_routing(ring.size()) {}
+
+        /**
+         * @return Number of hops of the lookup of key from origin, which then learns the nodes it met
+         */
+        size_t lookup(size_t origin, const util::uint256 &key)
+        {
+            std::vector<NodeInformation::Node> met{};
+            auto current = origin;
+            while (true) {
+                const auto &routing = routingTable(current);
+                if (util::is_in_range_loop(key, routing.predecessor->getKey(), routing.self, false, true))
+                    break;
+                if (util::is_in_range_loop(key, routing.self, routing.successor->getKey(), false, true)) {
+                    met.push_back(*routing.successor);
+                    break;
+                }
+                current = index(*routing.closestPreceding(key));
+                met.push_back(m_ring.node(current));
+            }
+            auto hops = met.size();
+            learn(origin, met);
+            return hops;
+        }
+
+    private:
+        NodeInformation::RoutingTable &routingTable(size_t n)
+        {
+            if (!m_routing[n])
+                m_routing[n] = m_ring.routingTable(n);
+            return *m_routing[n];
+        }
+
+        void learn(size_t n, const std::vector<NodeInformation::Node> &nodes)
+        {
+            if (m_capacity == 0)
+                return;
+            auto &routing = routingTable(n);
+            for (const auto &node: nodes) {
+                if (node.getKey() != routing.self && !routing.routesTo(node)) {
+                    routing.learned.push_back(routing.intern(node));
+                    routing.rebuild();
+                }
+            }
+            if (routing.learned.size() > m_capacity) {
+                routing.learned.erase(routing.learned.begin(),
+                                      routing.learned.end() - static_cast<std::ptrdiff_t>(m_capacity));
+                routing.rebuild();
+            }
+        }
+
+        [[nodiscard]] size_t index(const NodeInformation::Node &node) const
+        {
+            return m_ring.successorIndex(node.getId());
+        }
+
+        bench::Ring &m_ring;
+        const size_t m_capacity;
+        std::vector<std::optional<NodeInformation::RoutingTable>> m_routing;
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nodes = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t lookups = argc > 2 ? std::stoul(argv[2]) : 20000;
+    constexpr size_t hotKeys = 64;
+
+    std::cout << nodes << " nodes, " << lookups << " lookups, mean hops" << std::endl << std::endl
+              << std::setw(10) << "capacity" << std::setw(10) << "uniform" << std::setw(10) << "hot" << std::endl;
+
+    for (size_t capacity: {0ul, 8ul, 32ul, 128ul}) {
+        std::cout << std::setw(10) << capacity;
+        for (bool hot: {false, true}) {
+            // Same ring and lookups for every capacity.
+            bench::Ring ring(nodes);
+            Simulation simulation(ring, capacity);
+            std::vector<util::uint256> keys{};
+            for (size_t i = 0; i < hotKeys; ++i)
+                keys.emplace_back(bench::randomId(ring.random()));
+            std::uniform_int_distribution<size_t> pickNode(0, nodes - 1);
+            std::uniform_int_distribution<size_t> pickKey(0, hotKeys - 1);
+
+            size_t hops = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                auto origin = pickNode(ring.random());
+                auto key = hot ? keys[pickKey(ring.random())] : util::uint256(bench::randomId(ring.random()));
+                hops += simulation.lookup(origin, key);
+            }
+            std::cout << std::fixed << std::setprecision(2) << std::setw(10)
+                      << static_cast<double>(hops) / static_cast<double>(lookups);
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
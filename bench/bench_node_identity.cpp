@@ -0,0 +1,58 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <NodeInformation.h>
+#include <util.h>
+
+/*
+ * Cost of turning an address from an RPC response into a Node: hashing ip:port every time, as decoding used to do,
+ * compared to the interned identity.
+ *
+ * Usage: bench_node_identity [OPERATIONS]
+ */
+
+namespace
+{
+    template<typename F>
+    double nsPerOperation(size_t operations, F &&operation)
+    {
+        size_t sink = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < operations; ++i)
+            sink += operation(i);
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+        // Keeps the loop from being optimized away.
+        if (sink == 42)
+            std::cerr << "" << std::flush;
+        return elapsed / static_cast<double>(operations);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t operations = argc > 1 ? std::stoul(argv[1]) : 2000000;
+
+    // A ring neighbourhood: the handful of peers that appear in this node's routing responses.
+    constexpr size_t count = 64;
+    std::vector<std::pair<std::string, uint16_t>> addresses{};
+    for (size_t i = 0; i < count; ++i)
+        addresses.emplace_back("10.0." + std::to_string(i / 8) + "." + std::to_string(i % 8), static_cast<uint16_t>(6000 + i));
+
+    auto hashed = nsPerOperation(operations, [&](size_t i) {
+        const auto &[ip, port] = addresses[i % count];
+        auto id = util::hash_sha256(ip + ":" + std::to_string(port));
+        return static_cast<size_t>(id[i % id.size()]);
+    });
+    auto interned = nsPerOperation(operations, [&](size_t i) {
+        const auto &[ip, port] = addresses[i % count];
+        NodeInformation::Node node{ip, port};
+        return static_cast<size_t>(node.getKey().words[i % 4]);
+    });
+
+    std::cout << std::setw(12) << "hashed [ns]" << std::setw(14) << "interned [ns]" << std::setw(10) << "speedup"
+              << std::endl << std::fixed << std::setprecision(2)
+              << std::setw(12) << hashed << std::setw(14) << interned << std::setw(10) << hashed / interned << std::endl;
+    return 0;
+}
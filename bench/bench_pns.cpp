@@ -0,0 +1,119 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <optional>
+#include <random>
+#include <string>
+#include <NodeInformation.h>
+#include <FingerScheduler.h>
+#include "ring.h"
+
+/*
+ * Measures proximity neighbor selection in a simulated, converged ring in which every pair of nodes has a fixed
+ * one-way delay. Finger i of a node is the node with the lowest delay among the first CANDIDATES nodes of the
+ * finger's interval, as Dht::fixFingers chooses it; 1 candidate is plain Chord.
+ *
+ * Prints the mean number of hops and the mean lookup latency, recursive (one delay per hop) and iterative (the
+ * originator asks every hop, two delays per hop).
+ *
+ * Usage: bench_pns [NODES] [LOOKUPS]
+ */
+
+namespace
+{
+    class Simulation
+    {
+    public:
+        Simulation(bench::Ring &ring, const bench::Latencies &latency, size_t candidates)
+            : m_ring(ring), m_latency(latency), m_candidates(candidates), m_routing(ring.size()) {}
+
+        /**
+         * @return Nodes the lookup of key from origin visits, origin first
+         */
+        std::vector<size_t> route(size_t origin, const util::uint256 &key)
+        {
+            std::vector<size_t> path{origin};
+            while (true) {
+                const auto &routing = routingTable(path.back());
+                if (util::is_in_range_loop(key, routing.predecessor->getKey(), routing.self, false, true))
+                    return path;
+                if (util::is_in_range_loop(key, routing.self, routing.successor->getKey(), false, true))
+                    return path;
+                path.push_back(index(*routing.closestPreceding(key)));
+            }
+        }
+
+    private:
+        const NodeInformation::RoutingTable &routingTable(size_t n)
+        {
+            if (m_routing[n])
+                return *m_routing[n];
+
+            auto routing = m_ring.routingTable(n);
+            for (size_t i = 1; i < NodeInformation::key_bits && m_candidates > 1; ++i) {
+                auto successor = index(*routing.fingers[i]);
+                auto successorKey = util::uint256(m_ring.ids()[successor]);
+                if (!dht::FingerScheduler::isCandidate(routing.self, i, successorKey, successorKey))
+                    continue;
+                auto best = successor;
+                for (size_t c = 1; c < m_candidates; ++c) {
+                    auto candidate = (successor + c) % m_ring.size();
+                    if (candidate == n || !dht::FingerScheduler::isCandidate(
+                        routing.self, i, successorKey, util::uint256(m_ring.ids()[candidate])))
+                        break;
+                    if (m_latency(n, candidate) < m_latency(n, best))
+                        best = candidate;
+                }
+                routing.setFinger(i, m_ring.node(best));
+            }
+            routing.rebuild();
+            m_routing[n] = std::move(routing);
+            return *m_routing[n];
+        }
+
+        [[nodiscard]] size_t index(const NodeInformation::Node &node) const
+        {
+            return m_ring.successorIndex(node.getId());
+        }
+
+        bench::Ring &m_ring;
+        const bench::Latencies &m_latency;
+        const size_t m_candidates;
+        std::vector<std::optional<NodeInformation::RoutingTable>> m_routing;
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nodes = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t lookups = argc > 2 ? std::stoul(argv[2]) : 20000;
+
+    std::cout << nodes << " nodes, " << lookups << " lookups, one-way delays of 2ms to 143ms" << std::endl << std::endl
+              << std::setw(12) << "candidates" << std::setw(8) << "hops"
+              << std::setw(18) << "recursive [ms]" << std::setw(18) << "iterative [ms]" << std::endl;
+
+    for (size_t candidates: {1ul, 2ul, 4ul, 8ul, 16ul}) {
+        // Same ring, delays and lookups for every number of candidates.
+        bench::Ring ring(nodes);
+        bench::Latencies latency(nodes, ring.random());
+        Simulation simulation(ring, latency, candidates);
+        std::uniform_int_distribution<size_t> pick(0, nodes - 1);
+
+        double hops = 0.0, recursive = 0.0, iterative = 0.0;
+        for (size_t i = 0; i < lookups; ++i) {
+            auto origin = pick(ring.random());
+            auto path = simulation.route(origin, util::uint256(bench::randomId(ring.random())));
+            hops += static_cast<double>(path.size() - 1);
+            for (size_t h = 1; h < path.size(); ++h) {
+                recursive += latency(path[h - 1], path[h]);
+                iterative += 2 * latency(origin, path[h]);
+            }
+        }
+
+        auto count = static_cast<double>(lookups);
+        std::cout << std::setw(12) << candidates << std::fixed << std::setprecision(2) << std::setw(8) << hops / count
+                  << std::setprecision(1) << std::setw(18) << recursive / count << std::setw(18) << iterative / count
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <NodeInformation.h>
+#include "ring.h"
+
+/*
+ * Balance of the keys over the hosts of a ring in which every host takes vnodes ring positions per unit of capacity.
+ * Positions are derived from the address like a running node derives them, ip:port for vnode 0 and ip:port#i for
+ * vnode i.
+ *
+ * Prints the ratio of the highest to the mean load, for hosts of equal capacity, and for a mix of hosts with
+ * capacity 1, 2 and 4 in which a host's load is its share of the keys per unit of capacity. 1.0 is a perfect balance.
+ *
+ * Usage: bench_vnodes [HOSTS] [KEYS]
+ */
+
+namespace
+{
+    struct Position
+    {
+        NodeInformation::id_type id;
+        size_t host;
+
+        bool operator<(const Position &other) const { return id < other.id; }
+    };
+
+    /**
+     * @return Highest load per unit of capacity over the mean, for keys spread over hosts of the given capacities
+     */
+    double maxOverMean(const std::vector<size_t> &capacities, size_t vnodes, const std::vector<bench::id_type> &keys)
+    {
+        std::vector<Position> ring{};
+        for (size_t host = 0; host < capacities.size(); ++host) {
+            auto ip = "10.0." + std::to_string(host / 256) + "." + std::to_string(host % 256);
+            for (size_t vnode = 0; vnode < vnodes * capacities[host]; ++vnode) {
+                NodeInformation::Node node(ip, 6002, static_cast<uint16_t>(vnode));
+                ring.push_back({node.getId(), host});
+            }
+        }
+        std::sort(ring.begin(), ring.end());
+
+        std::vector<size_t> load(capacities.size(), 0);
+        for (const auto &key: keys) {
+            auto it = std::lower_bound(ring.begin(), ring.end(), Position{key, 0});
+            ++load[(it == ring.end() ? ring.front() : *it).host];
+        }
+
+        double totalCapacity = 0.0, highest = 0.0;
+        for (size_t host = 0; host < capacities.size(); ++host) {
+            auto capacity = static_cast<double>(capacities[host]);
+            totalCapacity += capacity;
+            highest = std::max(highest, static_cast<double>(load[host]) / capacity);
+        }
+        return highest / (static_cast<double>(keys.size()) / totalCapacity);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t hosts = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t keyCount = argc > 2 ? std::stoul(argv[2]) : 1000000;
+
+    std::mt19937_64 random(1);
+    std::vector<bench::id_type> keys{};
+    keys.reserve(keyCount);
+    for (size_t i = 0; i < keyCount; ++i)
+        keys.push_back(bench::randomId(random));
+
+    std::vector<size_t> equal(hosts, 1);
+    std::vector<size_t> mixed{};
+    for (size_t host = 0; host < hosts; ++host)
+        mixed.push_back(size_t{1} << (host % 3));
+
+    std::cout << hosts << " hosts, " << keyCount << " keys" << std::endl << std::endl
+              << std::setw(8) << "vnodes" << std::setw(14) << "equal hosts" << std::setw(14) << "mixed hosts"
+              << std::endl;
+    // The mix has hosts of capacity 4, which take 4 times as many vnodes, up to max_vnodes.
+    for (size_t vnodes: {1ul, 2ul, 4ul, 8ul, 16ul, 32ul, 64ul}) {
+        std::cout << std::setw(8) << vnodes << std::fixed << std::setprecision(2)
+                  << std::setw(14) << maxOverMean(equal, vnodes, keys)
+                  << std::setw(14) << maxOverMean(mixed, vnodes, keys) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#ifndef DHT_BENCH_RING_H
+#define DHT_BENCH_RING_H
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+#include <util.h>
+#include <NodeInformation.h>
+
+/**
+ * @brief A simulated, converged Chord ring, to benchmark routing without running any nodes.
+ */
+namespace bench
+{
+    using id_type = NodeInformation::id_type;
+
+    inline id_type randomId(std::mt19937_64 &random)
+    {
+        id_type id{};
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (auto &b: id)
+            b = static_cast<uint8_t>(byte(random));
+        return id;
+    }
+
+    class Ring
+    {
+    public:
+        explicit Ring(size_t size, uint64_t seed = 1) : m_random(seed)
+        {
+            m_ids.reserve(size);
+            for (size_t i = 0; i < size; ++i)
+                m_ids.push_back(randomId(m_random));
+            std::sort(m_ids.begin(), m_ids.end());
+        }
+
+        [[nodiscard]] const std::vector<id_type> &ids() const { return m_ids; }
+        [[nodiscard]] size_t size() const { return m_ids.size(); }
+        std::mt19937_64 &random() { return m_random; }
+
+        /**
+         * @return Index of the first node at or after id, going clockwise.
+         */
+        [[nodiscard]] size_t successorIndex(const id_type &id) const
+        {
+            auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+            return it == m_ids.end() ? 0 : static_cast<size_t>(it - m_ids.begin());
+        }
+
+        /**
+         * @brief A node with the given id. The address is made up, it is never contacted.
+         */
+        [[nodiscard]] NodeInformation::Node node(size_t index) const
+        {
+            return NodeInformation::Node("10.0.0.1", static_cast<uint16_t>(1024 + index % 60000), m_ids[index]);
+        }
+
+        /**
+         * @brief Routing table of node `index`, as stabilization would eventually build it.
+         */
+        [[nodiscard]] NodeInformation::RoutingTable routingTable(size_t index) const
+        {
+            NodeInformation::RoutingTable routing{};
+            routing.self = util::uint256(m_ids[index]);
+            for (size_t i = 0; i < NodeInformation::key_bits; ++i) {
+                auto start = routing.self + util::uint256::pow2(i);
+                routing.setFinger(i, node(successorIndex(start.bytes())));
+            }
+            routing.predecessor = routing.intern(node((index + m_ids.size() - 1) % m_ids.size()));
+            routing.rebuild();
+            return routing;
+        }
+
+    private:
+        std::mt19937_64 m_random;
+        std::vector<id_type> m_ids{};
+    };
+
+    /**
+     * @brief One-way delays between nodes placed at random in a square, 2ms to about 143ms.
+     */
+    class Latencies
+    {
+    public:
+        Latencies(size_t nodes, std::mt19937_64 &random)
+        {
+            std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+            for (size_t i = 0; i < nodes; ++i)
+                m_positions.emplace_back(coordinate(random), coordinate(random));
+        }
+
+        /**
+         * @return Delay between node a and node b in milliseconds
+         */
+        [[nodiscard]] double operator()(size_t a, size_t b) const
+        {
+            auto dx = m_positions[a].first - m_positions[b].first;
+            auto dy = m_positions[a].second - m_positions[b].second;
+            return 2.0 + 100.0 * std::sqrt(dx * dx + dy * dy);
+        }
+
+    private:
+        std::vector<std::pair<double, double>> m_positions{};
+    };
+} // namespace bench
+
+#endif //DHT_BENCH_RING_H
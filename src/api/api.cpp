@@ -4,24 +4,28 @@
 using namespace api;
 
 Api::Api(const Options &o):
+    m_options(o),
     m_service(std::make_unique<asio::io_service>()),
-    m_acceptor(std::make_unique<tcp::acceptor>(*m_service, tcp::endpoint(tcp::v4(), o.port)))
+    m_acceptor(std::make_unique<tcp::acceptor>(*m_service, tcp::endpoint(tcp::v4(), o.port))),
+    m_work(asio::make_work_guard(*m_service))
 {
     LOG_GET
     m_isRunning = true;
     start_accept();
-    m_serviceFuture = std::async(std::launch::async, [LOG_CAPTURE, this]() {
-        LOG_TRACE("run()");
-        while (m_isRunning) {
-            try {
-                m_service->run();
+    for (uint64_t i = 0; i < std::max<uint64_t>(o.threads, 1); ++i) {
+        m_serviceFutures.push_back(std::async(std::launch::async, [LOG_CAPTURE, this]() {
+            LOG_TRACE("run()");
+            while (m_isRunning) {
+                try {
+                    m_service->run();
+                }
+                catch (const std::exception &e) {
+                    LOG_WARN("{}", e.what());
+                }
             }
-            catch (const std::exception &e) {
-                LOG_WARN("{}", e.what());
-            }
-        }
-        LOG_TRACE("run() returned");
-    });
+            LOG_TRACE("run() returned");
+        }));
+    }
 }
 
 Api::~Api()
@@ -30,10 +34,13 @@ Api::~Api()
     SPDLOG_TRACE("closing acceptor");
     m_acceptor->close();
     SPDLOG_TRACE("stopping service");
+    m_work.reset();
     m_service->stop();
-    SPDLOG_TRACE("awaiting service future");
-    m_serviceFuture.get();
+    SPDLOG_TRACE("awaiting service futures");
+    for (auto &future: m_serviceFutures)
+        future.get();
 
+    std::lock_guard l{m_connectionsMutex};
     for (const auto &connection: m_openConnections) {
         connection->close();
     }
@@ -51,14 +58,33 @@ void Api::start_accept()
         LOG_INFO("acceptor is closed");
         return;
     }
-    m_acceptor->async_accept([LOG_CAPTURE, this](const asio::error_code &error, tcp::socket socket) {
-        start_accept();
-        if (error)
+    // Every accepted socket gets its own strand, so that a connection's handlers never run concurrently,
+    // while different connections are served by all threads.
+    m_acceptor->async_accept(asio::make_strand(*m_service), [LOG_CAPTURE, this](const asio::error_code &error, tcp::socket socket) {
+        if (error) {
             LOG_WARN("{}", error.message());
-        else
-            m_openConnections.push_back(std::make_unique<Connection>(std::move(socket), *this));
+        } else {
+            std::lock_guard l{m_connectionsMutex};
+            if (m_openConnections.size() >= m_options.max_connections) {
+                LOG_WARN("rejecting client, {} connections are open already", m_openConnections.size());
+                // Shut down in an orderly fashion, so that the client sees the end of the stream instead of a reset.
+                asio::error_code ec;
+                socket.shutdown(tcp::socket::shutdown_both, ec);
+                socket.close(ec);
+            } else {
+                auto connection = m_openConnections.insert(
+                    m_openConnections.end(), std::make_unique<Connection>(std::move(socket), *this));
+                (*connection)->start(connection);
+            }
+        }
+        start_accept();
+    });
+}
+
+void Api::release(Connection::list_iterator connection)
+{
+    asio::post(*m_service, [this, connection]() {
+        std::lock_guard l{m_connectionsMutex};
+        m_openConnections.erase(connection);
     });
-    m_openConnections.erase(
-        std::remove_if(m_openConnections.begin(), m_openConnections.end(), [](const std::unique_ptr<Connection> &connection) { return connection->isDone(); }),
-        m_openConnections.end());
 }
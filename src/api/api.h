@@ -9,16 +9,26 @@
 #include <functional>
 #include <type_traits>
 #include <map>
+#include <list>
+#include <mutex>
+#include <chrono>
 #include <centralLogControl.h>
 #include "message_data.h"
 #include "request.h"
 #include "connection.h"
+#include "response.h"
 
 namespace api
 {
     struct Options
     {
         uint16_t port = 1234ull;
+        /// Number of threads running the io_context. Each connection is serialized on its own strand.
+        uint64_t threads = 1;
+        /// While this many clients are connected, new clients are turned away.
+        uint64_t max_connections = 1024;
+        /// Clients that did not send a request for this long are disconnected. Zero disables the timeout.
+        std::chrono::seconds idle_timeout{0};
     };
 
     class Connection;
@@ -26,9 +36,9 @@ namespace api
     {
         using tcp = asio::ip::tcp;
 
-        using request_handler_t = std::function<std::vector<uint8_t>(const MessageData &message_data, std::atomic_bool &cancelled)>;
+        using request_handler_t = std::function<Response(const MessageData &message_data, std::atomic_bool &cancelled)>;
         template<typename MSG_TYPE, std::enable_if_t<util::is_one_of_v<MSG_TYPE, Message_KEY, Message_DHT_PUT, Message_DHT_PUT_KEY_IS_HASH_OF_DATA, Message_DHT_GET_KEY_IS_HASH_OF_DATA>, int> = 0>
-        using request_handler_specific_t = std::function<std::vector<uint8_t>(const MSG_TYPE &message_data, std::atomic_bool &cancelled)>;
+        using request_handler_specific_t = std::function<Response(const MSG_TYPE &message_data, std::atomic_bool &cancelled)>;
 
     public:
         explicit Api(const Options &o = {});
@@ -53,12 +63,21 @@ namespace api
 
     private:
         void start_accept();
+        /**
+         * @brief Called by a connection once it is closed and has nothing in flight anymore.
+         * The connection is destroyed asynchronously, outside of its own handlers.
+         */
+        void release(Connection::list_iterator connection);
+
+        const Options m_options;
 
         std::unique_ptr<asio::io_service> m_service{};
         std::unique_ptr<tcp::acceptor> m_acceptor{};
-        std::future<void> m_serviceFuture;
+        std::optional<asio::executor_work_guard<asio::io_service::executor_type>> m_work{};
+        std::vector<std::future<void>> m_serviceFutures{};
 
-        std::vector<std::unique_ptr<Connection>> m_openConnections{};
+        std::list<std::unique_ptr<Connection>> m_openConnections{};
+        std::mutex m_connectionsMutex{};
 
         std::map<uint16_t, request_handler_t> m_requestHandlers{};
 
@@ -1,36 +1,23 @@
 #include <centralLogControl.h>
 #include <util.h>
 #include "connection.h"
+#include "parser.h"
 #include "api.h"
 
 using api::Connection;
 
-Connection::Connection(tcp::socket &&sock, const Api &api) :
+Connection::Connection(tcp::socket &&sock, Api &api) :
     m_socket(std::move(sock)),
-    m_api(api)
-{
-    start_read();
-
-    m_handlerCallManager = std::async(std::launch::async, [this]() {
-        using namespace std::chrono_literals;
-
-        while (m_socket.is_open()) {
-
-            if (!m_handlerCalls.empty() && m_handlerCalls[0].wait_for(0s) == std::future_status::ready) {
-
-                m_handlerCallMutex.lock();
-                auto bytes = m_handlerCalls.front().get();
-                m_handlerCalls.pop_front();
-                m_handlerCallMutex.unlock();
+    m_api(api),
+    m_idleTimer(m_socket.get_executor()) {}
 
-                if (m_socket.is_open() && !bytes.empty()) {
-                    m_socket.write_some(asio::buffer(bytes));
-                }
-            }
-
-            std::this_thread::sleep_for(100ms);
-        }
-        m_done = true;
+void Connection::start(list_iterator self)
+{
+    m_self = self;
+    m_lastActivity = std::chrono::steady_clock::now();
+    asio::post(m_socket.get_executor(), [this]() {
+        start_idle_timer();
+        start_read();
     });
 }
 
@@ -39,19 +26,26 @@ void Connection::start_read() // NOLINT
     LOG_GET
     if (!m_socket.is_open()) {
         LOG_INFO("disconnected!");
+        check_done();
         return;
     }
 
+    m_readInProgress = true;
     asio::async_read(
         m_socket,
-        asio::buffer(m_header),
-        [LOG_CAPTURE, this](const asio::error_code &error, std::size_t length) { // NOLINT
-            finish_read();
+        asio::buffer(m_data.data(), sizeof(MessageHeader::MessageHeaderRaw)),
+        [LOG_CAPTURE, this](const asio::error_code &error, std::size_t) { // NOLINT
+            m_readInProgress = false;
 
             if (error) {
                 LOG_INFO("{}", error.message());
+                close();
+                check_done();
                 return;
             }
+
+            m_lastActivity = std::chrono::steady_clock::now();
+            finish_read();
         }
     );
 }
@@ -61,60 +55,193 @@ void Connection::finish_read() // NOLINT
     LOG_GET
     if (!m_socket.is_open()) {
         LOG_INFO("disconnected!");
+        check_done();
         return;
     }
 
-    MessageHeader header(reinterpret_cast<MessageHeader::MessageHeaderRaw &>(m_header[0]));
+    MessageHeader header(reinterpret_cast<MessageHeader::MessageHeaderRaw &>(m_data[0]));
+
+    // The header is checked before its body is read. There is no way to find the next frame
+    // in the stream after a bad one, so the client is disconnected.
+    if (auto status = parser::validateHeader(header); status != parser::Status::OK) {
+        LOG_WARN("rejecting frame (size: {}, type: {}): {}", header.size, header.msg_type, parser::to_string(status));
+        close();
+        check_done();
+        return;
+    }
 
+    m_readInProgress = true;
     asio::async_read(
         m_socket,
-        asio::buffer(m_data, header.size - sizeof(MessageHeader::MessageHeaderRaw)),
-        [LOG_CAPTURE, this, header(std::move(header))](const asio::error_code &error, std::size_t length) { // NOLINT
-            std::vector<uint8_t> bytes(m_header.size() + length);
-            std::copy(m_header.begin(), m_header.end(), bytes.begin());
-            std::copy(
-                m_data.begin(),
-                m_data.begin() + static_cast<long>(length),
-                bytes.begin() + static_cast<long>(m_header.size())
-            );
-
-            start_read();
+        asio::buffer(m_data.data() + sizeof(MessageHeader::MessageHeaderRaw),
+                     header.size - sizeof(MessageHeader::MessageHeaderRaw)),
+        [LOG_CAPTURE, this, header](const asio::error_code &error, std::size_t) { // NOLINT
+            m_readInProgress = false;
 
             if (error) {
                 LOG_INFO("{}", error.message());
+                close();
+                check_done();
                 return;
             }
 
-            if (length > 0ull) {
-                LOG_INFO("Got Data!\n{}\n", util::hexdump(bytes, 16, true, true));
-
-                std::unique_ptr<Request> request;
-                try {
-                    request = std::make_unique<Request>(header, bytes);
-                }
-                catch (const std::exception &e) {
-                    LOG_WARN("Exception thrown when parsing request:\n\t\t{}", e.what());
-                    return;
-                }
-                if (m_socket.is_open()) {
-                    auto t = request->getData()->m_header.msg_type;
-                    if (m_api.m_requestHandlers.contains(t)) {
-                        m_handlerCallMutex.lock();
-                        m_handlerCalls.push_back(std::async(std::launch::async, [this, request(std::move(request))]() {
-                            return m_api.m_requestHandlers.find(request->getData()->m_header.msg_type)->second(
-                                *(request->getData<>()), cancellation_token);
-                        }));
-                        m_handlerCallMutex.unlock();
-                    }
-                }
+            std::span<const uint8_t> frameBytes(m_data.data(), header.size);
+            parser::Frame frame{};
+            if (auto status = parser::parse(frameBytes, frame); status != parser::Status::OK) {
+                LOG_WARN("rejecting frame: {}", parser::to_string(status));
+                close();
+                check_done();
+                return;
+            }
+
+            LOG_INFO("Got Data!\n{}\n", util::hexdump(frameBytes, 16, true, true));
+
+            // The request is decoded from the views of the parsed frame, and copied out of the read buffer before
+            // the next read reuses it.
+            std::unique_ptr<Request> request;
+            try {
+                request = std::make_unique<Request>(frame);
+            }
+            catch (const std::exception &e) {
+                LOG_WARN("Exception thrown when decoding request:\n\t\t{}", e.what());
+                start_read();
+                return;
+            }
+            start_read();
+            if (m_socket.is_open() && m_api.m_requestHandlers.contains(request->getData()->m_header.msg_type))
+                dispatch(std::move(request));
+        }
+    );
+}
+
+void Connection::dispatch(std::unique_ptr<Request> request)
+{
+    auto sequence = m_nextSequence++;
+    m_handlerCalls.push_back(std::async(std::launch::async, [this, sequence, request(std::move(request))]() {
+        Response response{};
+        try {
+            response = m_api.m_requestHandlers.find(request->getData()->m_header.msg_type)->second(
+                *(request->getData<>()), cancellation_token);
+        }
+        catch (const std::exception &e) {
+            SPDLOG_WARN("Exception thrown by request handler:\n\t\t{}", e.what());
+        }
+        // Hand the result back to the socket's executor, the socket must not be touched from this thread.
+        asio::post(m_socket.get_executor(), [this, sequence, response(std::move(response))]() mutable {
+            complete(sequence, std::move(response));
+        });
+    }));
+}
+
+void Connection::complete(std::size_t sequence, Response response)
+{
+    m_completed.emplace(sequence, std::move(response));
+
+    // Queue every response that is next in line, so that the client gets them in the order it sent the requests.
+    for (auto it = m_completed.find(m_nextToWrite); it != m_completed.end(); it = m_completed.find(m_nextToWrite)) {
+        queue_write(std::move(it->second));
+        m_completed.erase(it);
+        ++m_nextToWrite;
+    }
+
+    // Handlers that posted their result have finished, their futures can be released.
+    while (!m_handlerCalls.empty() &&
+           m_handlerCalls.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        m_handlerCalls.pop_front();
+    }
+
+    check_done();
+}
+
+void Connection::queue_write(Response response)
+{
+    if (response.empty() || !m_socket.is_open())
+        return;
+    m_writeQueue.push_back(std::move(response));
+    if (!m_writeInProgress)
+        start_write();
+}
+
+void Connection::start_write() // NOLINT
+{
+    LOG_GET
+    if (m_writeQueue.empty() || !m_socket.is_open()) {
+        m_writeInProgress = false;
+        m_writeQueue.clear();
+        check_done();
+        return;
+    }
+
+    // Everything that piled up while the last write was in progress goes out with one syscall.
+    m_writeInProgress = true;
+    m_writing.swap(m_writeQueue);
+    m_gather.clear();
+    for (const auto &response: m_writing)
+        for (const auto &segment: response.segments())
+            m_gather.push_back(asio::buffer(segment));
+
+    asio::async_write(
+        m_socket,
+        m_gather,
+        [LOG_CAPTURE, this](const asio::error_code &error, std::size_t) { // NOLINT
+            m_writing.clear();
+
+            if (error) {
+                LOG_INFO("{}", error.message());
+                close();
             }
+
+            start_write();
         }
     );
 }
 
+void Connection::start_idle_timer() // NOLINT
+{
+    auto timeout = m_api.m_options.idle_timeout;
+    if (timeout.count() <= 0 || !m_socket.is_open())
+        return;
+
+    m_idleTimerPending = true;
+    m_idleTimer.expires_at(m_lastActivity + timeout);
+    m_idleTimer.async_wait([this, timeout](const asio::error_code &error) { // NOLINT
+        m_idleTimerPending = false;
+        if (error || !m_socket.is_open()) {
+            check_done();
+            return;
+        }
+
+        // A client that is still waiting for a response is not idle.
+        if (m_nextSequence != m_nextToWrite)
+            m_lastActivity = std::chrono::steady_clock::now();
+
+        if (std::chrono::steady_clock::now() - m_lastActivity >= timeout) {
+            SPDLOG_INFO("closing idle connection");
+            close();
+            check_done();
+        } else {
+            start_idle_timer();
+        }
+    });
+}
+
+void Connection::check_done()
+{
+    if (m_done || m_socket.is_open() || m_readInProgress || m_writeInProgress || m_nextSequence != m_nextToWrite)
+        return;
+    if (m_idleTimerPending) {
+        // The timer's handler calls this again once it was cancelled.
+        m_idleTimer.cancel();
+        return;
+    }
+    m_done = true;
+    m_api.release(m_self);
+}
+
 void Connection::close()
 {
-    m_socket.close();
+    asio::error_code ec;
+    m_socket.close(ec);
 }
 
 bool Connection::isDone() const
@@ -125,4 +252,6 @@ bool Connection::isDone() const
 Connection::~Connection()
 {
     cancellation_token = true;
-}
\ No newline at end of file
+    // Wait for outstanding handlers before the rest of this object is destroyed.
+    m_handlerCalls.clear();
+}
@@ -5,10 +5,15 @@
 #include <queue>
 #include <future>
 #include <vector>
+#include <map>
+#include <list>
+#include <chrono>
 #include <cstdint>
 #include <atomic>
 #include <mutex>
 #include "message_data.h"
+#include "request.h"
+#include "response.h"
 
 namespace api
 {
@@ -19,14 +24,21 @@ namespace api
         using tcp = asio::ip::tcp;
 
     public:
+        using list_iterator = std::list<std::unique_ptr<Connection>>::iterator;
+
         Connection() = delete;
-        Connection(tcp::socket &&socket, const Api &api);
+        Connection(tcp::socket &&socket, Api &api);
         Connection(const Connection &other) = delete;
         Connection(Connection &&other) = delete;
 
         Connection &operator=(const Connection &other) = delete;
         Connection &operator=(Connection &&other) = delete;
 
+        /**
+         * @brief Start serving the client.
+         * @param self - Position of this connection in the api's list, used to remove it once it is done.
+         */
+        void start(list_iterator self);
         void close();
         [[nodiscard]] bool isDone() const;
 
@@ -36,18 +48,55 @@ namespace api
         void start_read();
         void finish_read();
 
-        std::array<uint8_t, sizeof(api::MessageHeader::MessageHeaderRaw)> m_header;
-        std::vector<uint8_t> m_data = std::vector<uint8_t>((1 << 16) - 1, 0);
+        /**
+         * @brief Runs the request handler asynchronously. The result is posted back onto the socket's executor.
+         */
+        void dispatch(std::unique_ptr<Request> request);
+        /**
+         * @brief Called on the socket's executor once the handler for request number `sequence` has returned.
+         * Responses are queued in the order in which the requests arrived.
+         */
+        void complete(std::size_t sequence, Response response);
+        void queue_write(Response response);
+        /**
+         * @brief Write everything that is queued with a single gather write.
+         */
+        void start_write();
+        /**
+         * @brief Closes the connection if no request was received for the api's idle timeout.
+         */
+        void start_idle_timer();
+        /**
+         * @brief Once the socket is closed and nothing is in flight anymore, the connection removes itself from the api.
+         */
+        void check_done();
+
+        /// Holds the frame that is being read, header first. A frame can be at most UINT16_MAX bytes long.
+        std::vector<uint8_t> m_data = std::vector<uint8_t>(UINT16_MAX, 0);
 
         tcp::socket m_socket;
-        const Api &m_api;
+        Api &m_api;
+        list_iterator m_self{};
 
         std::atomic_bool m_done = false;
+        bool m_readInProgress{false};
+
+        asio::steady_timer m_idleTimer;
+        std::chrono::steady_clock::time_point m_lastActivity{};
+        bool m_idleTimerPending{false};
+
+        // Everything below is only touched from the socket's executor.
+
+        std::deque<std::future<void>> m_handlerCalls;
+        std::size_t m_nextSequence{0};
+        std::size_t m_nextToWrite{0};
+        std::map<std::size_t, Response> m_completed{};
 
-        std::deque<std::future<std::vector<uint8_t>>>
-            m_handlerCalls;
-        std::future<void> m_handlerCallManager;
-        std::mutex m_handlerCallMutex;
+        std::deque<Response> m_writeQueue{};
+        /// Responses owned by the write that is currently in progress.
+        std::deque<Response> m_writing{};
+        std::vector<asio::const_buffer> m_gather{};
+        bool m_writeInProgress{false};
 
         std::atomic_bool cancellation_token{false};
     };
@@ -1,6 +1,8 @@
 #include "message_data.h"
+#include "parser.h"
 #include <iostream>
 #include <exception>
+#include <stdexcept>
 
 api::MessageHeader::MessageHeader(uint16_t size, uint16_t msg_type) :
     size(size), msg_type(msg_type) {}
@@ -34,22 +36,23 @@ api::MessageHeaderExtend::operator MessageHeaderRaw() const
 }
 
 api::MessageData::MessageData(std::vector<uint8_t> bytes) :
-    m_bytes(std::move(bytes)),
-    m_header(MessageHeader(reinterpret_cast<MessageHeader::MessageHeaderRaw &>(m_bytes[0]))) {}
-
-api::Message_DHT_PUT::Message_DHT_PUT(std::vector<uint8_t> bytes) :
-    MessageData(std::move(bytes)),
-    m_headerExtend(MessageHeaderExtend(
-        reinterpret_cast<MessageHeaderExtend::MessageHeaderRaw &>(m_bytes[sizeof(MessageHeader::MessageHeaderRaw)]))),
-    key(m_bytes.begin() + sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw),
-        m_bytes.begin() +
-        (sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw) + 32)),
-    value(m_bytes.begin() +
-          (sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw) + 32),
-          m_bytes.begin() + m_header.size)
+    m_bytes(std::move(bytes))
 {
-    if (m_header.size < sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw) + 32)
-        throw std::runtime_error("Key is too small!");
+    if (m_bytes.size() < sizeof(MessageHeader::MessageHeaderRaw))
+        throw std::runtime_error("Message is too small!");
+    m_header = MessageHeader(reinterpret_cast<MessageHeader::MessageHeaderRaw &>(m_bytes[0]));
+}
+
+api::MessageData::MessageData(const parser::Frame &frame) :
+    m_bytes(frame.bytes.begin(), frame.bytes.end()),
+    m_header(frame.header) {}
+
+api::Message_DHT_PUT::Message_DHT_PUT(const parser::Frame &frame) :
+    MessageData(frame)
+{
+    m_headerExtend = frame.headerExtend;
+    key.assign(frame.key.begin(), frame.key.end());
+    value.assign(frame.value.begin(), frame.value.end());
 }
 
 api::Message_DHT_PUT::Message_DHT_PUT(const std::vector<uint8_t> &key, const std::vector<uint8_t> &value,
@@ -78,31 +81,19 @@ api::Message_DHT_PUT::Message_DHT_PUT(const std::vector<uint8_t> &key, const std
     );
 }
 
-api::Message_DHT_PUT_KEY_IS_HASH_OF_DATA::Message_DHT_PUT_KEY_IS_HASH_OF_DATA(std::vector<uint8_t> bytes) :
-    MessageData(std::move(bytes)),
-    m_headerExtend(MessageHeaderExtend(
-        reinterpret_cast<MessageHeaderExtend::MessageHeaderRaw &>(m_bytes[sizeof(MessageHeader::MessageHeaderRaw)]))),
-    value(m_bytes.begin() +
-    (sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw)),
-    m_bytes.begin() + m_header.size)
+api::Message_DHT_PUT_KEY_IS_HASH_OF_DATA::Message_DHT_PUT_KEY_IS_HASH_OF_DATA(const parser::Frame &frame) :
+    MessageData(frame)
 {
+    m_headerExtend = frame.headerExtend;
+    value.assign(frame.value.begin(), frame.value.end());
     key = value;
-
-    if (m_header.size < sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw))
-        throw std::runtime_error("Message is too small!");
 }
 
-api::Message_DHT_SUCCESS::Message_DHT_SUCCESS(std::vector<uint8_t> bytes) :
-    MessageData(std::move(bytes)),
-    key(m_bytes.begin() + sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw),
-        m_bytes.begin() +
-        (sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw) + 32)),
-    value(m_bytes.begin() +
-          (sizeof(MessageHeader::MessageHeaderRaw) + sizeof(MessageHeaderExtend::MessageHeaderRaw) + 32),
-          m_bytes.begin() + m_header.size)
+api::Message_DHT_SUCCESS::Message_DHT_SUCCESS(const parser::Frame &frame) :
+    MessageData(frame)
 {
-    if (m_header.size < sizeof(MessageHeader::MessageHeaderRaw) + 32)
-        throw std::runtime_error("Key is too small!");
+    key.assign(frame.key.begin(), frame.key.end());
+    value.assign(frame.value.begin(), frame.value.end());
 }
 
 api::Message_DHT_SUCCESS::Message_DHT_SUCCESS(const std::vector<uint8_t> &key, const std::vector<uint8_t> &value) :
@@ -123,13 +114,10 @@ api::Message_DHT_SUCCESS::Message_DHT_SUCCESS(const std::vector<uint8_t> &key, c
     );
 }
 
-api::Message_KEY::Message_KEY(std::vector<uint8_t> bytes) :
-    MessageData(std::move(bytes)),
-    key(m_bytes.begin() + sizeof(MessageHeader::MessageHeaderRaw),
-        m_bytes.begin() + (sizeof(MessageHeader::MessageHeaderRaw) + 32))
+api::Message_KEY::Message_KEY(const parser::Frame &frame) :
+    MessageData(frame)
 {
-    if (m_header.size < sizeof(MessageHeader::MessageHeaderRaw) + 32)
-        throw std::runtime_error("Key is too small!");
+    key.assign(frame.key.begin(), frame.key.end());
 }
 
 api::Message_KEY::Message_KEY(uint16_t msg_type, const std::vector<uint8_t> &key) :
@@ -140,13 +128,10 @@ api::Message_KEY::Message_KEY(uint16_t msg_type, const std::vector<uint8_t> &key
     std::copy(key.begin(), key.end(), m_bytes.begin() + sizeof(MessageHeader::MessageHeaderRaw));
 }
 
-api::Message_DHT_GET_KEY_IS_HASH_OF_DATA::Message_DHT_GET_KEY_IS_HASH_OF_DATA(std::vector<uint8_t> bytes) :
-MessageData(std::move(bytes)),
-key(m_bytes.begin() + sizeof(MessageHeader::MessageHeaderRaw),
-    m_bytes.end())
+api::Message_DHT_GET_KEY_IS_HASH_OF_DATA::Message_DHT_GET_KEY_IS_HASH_OF_DATA(const parser::Frame &frame) :
+MessageData(frame)
 {
-    if (m_header.size < sizeof(MessageHeader::MessageHeaderRaw))
-        throw std::runtime_error("Key is too small!");
+    key.assign(frame.key.begin(), frame.key.end());
 }
 
 api::Message_DHT_GET_KEY_IS_HASH_OF_DATA::Message_DHT_GET_KEY_IS_HASH_OF_DATA(uint16_t msg_type, const std::vector<uint8_t> &key) :
@@ -8,6 +8,11 @@
 
 namespace api
 {
+    namespace parser
+    {
+        struct Frame;
+    }
+
     struct MessageHeader
     {
 #pragma pack(push, 2)
@@ -52,6 +57,8 @@ namespace api
         MessageHeader m_header;
 
         MessageData(std::vector<uint8_t> bytes); // NOLINT
+        /// Copies the frame out of the read buffer, the frame is not parsed again.
+        explicit MessageData(const parser::Frame &frame);
 
         virtual ~MessageData() = default;
 
@@ -64,7 +71,7 @@ namespace api
 
         std::vector<uint8_t> key, value;
 
-        Message_DHT_PUT(std::vector<uint8_t> bytes); // NOLINT
+        explicit Message_DHT_PUT(const parser::Frame &frame);
         Message_DHT_PUT(const std::vector<uint8_t> &key, const std::vector<uint8_t> &value,
                         uint16_t ttl = 0, uint8_t replication = 0);
     };
@@ -75,14 +82,14 @@ namespace api
 
         std::vector<uint8_t> key, value;
 
-        Message_DHT_PUT_KEY_IS_HASH_OF_DATA(std::vector<uint8_t> bytes); // NOLINT
+        explicit Message_DHT_PUT_KEY_IS_HASH_OF_DATA(const parser::Frame &frame);
     };
 
     struct Message_DHT_SUCCESS : MessageData
     {
         std::vector<uint8_t> key, value;
 
-        Message_DHT_SUCCESS(std::vector<uint8_t> bytes); // NOLINT
+        explicit Message_DHT_SUCCESS(const parser::Frame &frame);
         Message_DHT_SUCCESS(const std::vector<uint8_t> &key, const std::vector<uint8_t> &value);
     };
 
@@ -90,7 +97,7 @@ namespace api
     {
         std::vector<uint8_t> key;
 
-        Message_KEY(std::vector<uint8_t> bytes); // NOLINT
+        explicit Message_KEY(const parser::Frame &frame);
         Message_KEY(uint16_t msg_type, const std::vector<uint8_t> &key);
     };
 
@@ -98,7 +105,7 @@ namespace api
     {
         std::vector<uint8_t> key;
 
-        Message_DHT_GET_KEY_IS_HASH_OF_DATA(std::vector<uint8_t> bytes); // NOLINT
+        explicit Message_DHT_GET_KEY_IS_HASH_OF_DATA(const parser::Frame &frame);
         Message_DHT_GET_KEY_IS_HASH_OF_DATA(uint16_t msg_type, const std::vector<uint8_t> &key);
     };
 
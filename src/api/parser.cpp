@@ -0,0 +1,78 @@
+#include "parser.h"
+
+namespace api::parser
+{
+    namespace
+    {
+        constexpr Layout put_layout{.extended_header= true, .key_size= 32, .has_value= true};
+        constexpr Layout key_layout{.extended_header= false, .key_size= 32, .has_value= false};
+        constexpr Layout success_layout{.extended_header= false, .key_size= 32, .has_value= true};
+        constexpr Layout put_key_is_hash_layout{.extended_header= true, .key_size= 0, .has_value= true};
+
+        constexpr uint16_t read16(const uint8_t *bytes)
+        {
+            return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+        }
+    }
+
+    const char *to_string(Status status)
+    {
+        switch (status) {
+            case Status::OK: return "ok";
+            case Status::INCOMPLETE: return "incomplete frame";
+            case Status::TRAILING_BYTES: return "trailing bytes after frame";
+            case Status::BAD_SIZE: return "size not allowed for message type";
+            case Status::UNKNOWN_TYPE: return "unknown message type";
+        }
+        return "unknown status";
+    }
+
+    const Layout *layout(uint16_t msg_type)
+    {
+        switch (msg_type) {
+            case util::constants::DHT_PUT: return &put_layout;
+            case util::constants::DHT_GET: return &key_layout;
+            case util::constants::DHT_SUCCESS: return &success_layout;
+            case util::constants::DHT_FAILURE: return &key_layout;
+            case util::constants::DHT_PUT_KEY_IS_HASH_OF_DATA: return &put_key_is_hash_layout;
+            case util::constants::DHT_GET_KEY_IS_HASH_OF_DATA: return &key_layout;
+            default: return nullptr;
+        }
+    }
+
+    Status validateHeader(const MessageHeader &header)
+    {
+        const auto *l = layout(header.msg_type);
+        if (!l)
+            return Status::UNKNOWN_TYPE;
+        if (header.size < l->min_size() || header.size > l->max_size())
+            return Status::BAD_SIZE;
+        return Status::OK;
+    }
+
+    Status parse(std::span<const uint8_t> bytes, Frame &frame)
+    {
+        if (bytes.size() < sizeof(MessageHeader::MessageHeaderRaw))
+            return Status::INCOMPLETE;
+
+        frame.header = MessageHeader(read16(&bytes[0]), read16(&bytes[2]));
+        if (auto status = validateHeader(frame.header); status != Status::OK)
+            return status;
+        if (bytes.size() < frame.header.size)
+            return Status::INCOMPLETE;
+        if (bytes.size() > frame.header.size)
+            return Status::TRAILING_BYTES;
+
+        const auto &l = *layout(frame.header.msg_type);
+        size_t offset = sizeof(MessageHeader::MessageHeaderRaw);
+        frame.headerExtend = {};
+        if (l.extended_header) {
+            frame.headerExtend = MessageHeaderExtend(read16(&bytes[offset]), bytes[offset + 2], bytes[offset + 3]);
+            offset += sizeof(MessageHeaderExtend::MessageHeaderRaw);
+        }
+        frame.bytes = bytes;
+        frame.key = bytes.subspan(offset, l.key_size);
+        frame.value = bytes.subspan(offset + l.key_size);
+        return Status::OK;
+    }
+} // namespace api::parser
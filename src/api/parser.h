@@ -0,0 +1,79 @@
+#ifndef DHT_API_PARSER_H
+#define DHT_API_PARSER_H
+
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <constants.h>
+#include "message_data.h"
+
+namespace api::parser
+{
+    enum class Status
+    {
+        OK,
+        /// Fewer bytes than a header, or than the size given in the header.
+        INCOMPLETE,
+        /// More bytes than the size given in the header.
+        TRAILING_BYTES,
+        /// The header's size is too small or too large for the message type.
+        BAD_SIZE,
+        UNKNOWN_TYPE
+    };
+
+    [[nodiscard]] const char *to_string(Status status);
+
+    /**
+     * @brief Size limits of a message type, checked before its body is read.
+     */
+    struct Layout
+    {
+        bool extended_header;
+        uint16_t key_size;
+        bool has_value;
+
+        [[nodiscard]] constexpr uint16_t min_size() const
+        {
+            return static_cast<uint16_t>(
+                sizeof(MessageHeader::MessageHeaderRaw) +
+                (extended_header ? sizeof(MessageHeaderExtend::MessageHeaderRaw) : 0) +
+                key_size);
+        }
+
+        [[nodiscard]] constexpr uint16_t max_size() const
+        {
+            return has_value ? UINT16_MAX : min_size();
+        }
+    };
+
+    /**
+     * @return Layout of the message type, or nullptr for unknown types.
+     */
+    [[nodiscard]] const Layout *layout(uint16_t msg_type);
+
+    /**
+     * @brief Validates a header alone, so that a bad frame is rejected before its body is read.
+     */
+    [[nodiscard]] Status validateHeader(const MessageHeader &header);
+
+    /**
+     * @brief A validated message. bytes, key and value point into the parsed buffer, nothing is copied.
+     */
+    struct Frame
+    {
+        std::span<const uint8_t> bytes{};
+        MessageHeader header{};
+        MessageHeaderExtend headerExtend{};
+        std::span<const uint8_t> key{};
+        std::span<const uint8_t> value{};
+    };
+
+    /**
+     * @brief Validates and decodes one complete frame in a single pass, without allocating.
+     * @param bytes - exactly one frame, as announced by its header
+     * @param frame - only valid if OK is returned
+     */
+    [[nodiscard]] Status parse(std::span<const uint8_t> bytes, Frame &frame);
+} // namespace api::parser
+
+#endif //DHT_API_PARSER_H
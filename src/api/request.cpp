@@ -1,4 +1,5 @@
 #include "request.h"
+#include "parser.h"
 
 #include <iostream>
 #include <utility>
@@ -6,29 +7,25 @@
 
 using namespace api;
 
-Request::Request(MessageHeader header, std::vector<uint8_t> bytes) :
-    m_rawBytes(std::move(bytes))
+Request::Request(const parser::Frame &frame)
 {
-    if (m_rawBytes.size() < header.size)
-        throw bad_buffer_size("buffer smaller than specified in header");
-
-    if (header.msg_type == util::constants::DHT_PUT) {
-        m_decodedData = std::make_unique<Message_DHT_PUT>(m_rawBytes);
-    } else if (header.msg_type == util::constants::DHT_GET) {
-        m_decodedData = std::make_unique<Message_KEY>(m_rawBytes);
-    } else if (header.msg_type == util::constants::DHT_PUT_KEY_IS_HASH_OF_DATA) {
-        m_decodedData = std::make_unique<Message_DHT_PUT_KEY_IS_HASH_OF_DATA>(m_rawBytes);
-    } else if (header.msg_type == util::constants::DHT_GET_KEY_IS_HASH_OF_DATA) {
-        m_decodedData = std::make_unique<Message_DHT_GET_KEY_IS_HASH_OF_DATA>(m_rawBytes);
+    auto type = frame.header.msg_type;
+    if (type == util::constants::DHT_PUT) {
+        m_decodedData = std::make_unique<Message_DHT_PUT>(frame);
+    } else if (type == util::constants::DHT_GET) {
+        m_decodedData = std::make_unique<Message_KEY>(frame);
+    } else if (type == util::constants::DHT_PUT_KEY_IS_HASH_OF_DATA) {
+        m_decodedData = std::make_unique<Message_DHT_PUT_KEY_IS_HASH_OF_DATA>(frame);
+    } else if (type == util::constants::DHT_GET_KEY_IS_HASH_OF_DATA) {
+        m_decodedData = std::make_unique<Message_DHT_GET_KEY_IS_HASH_OF_DATA>(frame);
     } else {
-        throw bad_request("message type incorrect: " + std::to_string(header.msg_type));
+        throw bad_request("message type incorrect: " + std::to_string(type));
     }
 }
 
 Request::Request(Request &&other) noexcept
 {
     if (this != &other) {
-        m_rawBytes = std::move(other.m_rawBytes);
         m_decodedData = std::move(other.m_decodedData);
     }
 }
@@ -36,7 +33,6 @@ Request::Request(Request &&other) noexcept
 Request &Request::operator=(Request &&other) noexcept
 {
     if (this != &other) {
-        m_rawBytes = std::move(other.m_rawBytes);
         m_decodedData = std::move(other.m_decodedData);
     }
     return *this;
@@ -44,5 +40,5 @@ Request &Request::operator=(Request &&other) noexcept
 
 std::vector<uint8_t> Request::getBytes() const
 {
-    return m_rawBytes;
+    return m_decodedData->m_bytes;
 }
\ No newline at end of file
@@ -17,18 +17,17 @@ namespace api
     class Request
     {
     public:
-        class bad_buffer_size : public std::runtime_error
-        {
-            using std::runtime_error::runtime_error;
-        };
-
         class bad_request : public std::runtime_error
         {
             using std::runtime_error::runtime_error;
         };
 
         // Constructors
-        Request(MessageHeader messageHeader, std::vector<uint8_t> bytes);
+        /**
+         * @param frame - validated by parser::parse, only its views are read
+         * @throws bad_request if the frame is not a request
+         */
+        explicit Request(const parser::Frame &frame);
 
         Request(Request &&other) noexcept;
         Request(const Request &other) = delete;
@@ -45,7 +44,6 @@ namespace api
         }
 
     private:
-        std::vector<uint8_t> m_rawBytes;
         std::unique_ptr<MessageData> m_decodedData;
     };
 } // namespace API
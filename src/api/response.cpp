@@ -0,0 +1,59 @@
+#include "response.h"
+#include <numeric>
+#include <utility>
+
+using api::Response;
+
+Response::Response(std::vector<uint8_t> bytes)
+{
+    append(std::move(bytes));
+}
+
+Response::Response(const MessageData &message) :
+    Response(message.m_bytes) {}
+
+Response Response::success(std::vector<uint8_t> key, std::vector<uint8_t> value)
+{
+    auto size = sizeof(MessageHeader::MessageHeaderRaw) + key.size() + value.size();
+    auto raw = MessageHeader::MessageHeaderRaw(MessageHeader(static_cast<uint16_t>(size), util::constants::DHT_SUCCESS));
+    auto *rawBytes = reinterpret_cast<const uint8_t *>(&raw);
+
+    Response ret{};
+    ret.append({rawBytes, rawBytes + sizeof(raw)});
+    ret.append(std::move(key));
+    ret.append(std::move(value));
+    return ret;
+}
+
+Response &Response::append(std::vector<uint8_t> segment)
+{
+    if (!segment.empty())
+        m_segments.push_back(std::move(segment));
+    return *this;
+}
+
+bool Response::empty() const
+{
+    return m_segments.empty();
+}
+
+std::size_t Response::size() const
+{
+    return std::accumulate(
+        m_segments.begin(), m_segments.end(), std::size_t{0},
+        [](std::size_t sum, const std::vector<uint8_t> &segment) { return sum + segment.size(); });
+}
+
+const std::vector<std::vector<uint8_t>> &Response::segments() const
+{
+    return m_segments;
+}
+
+Response::operator std::vector<uint8_t>() const
+{
+    std::vector<uint8_t> ret{};
+    ret.reserve(size());
+    for (const auto &segment: m_segments)
+        ret.insert(ret.end(), segment.begin(), segment.end());
+    return ret;
+}
@@ -0,0 +1,48 @@
+#ifndef DHT_API_RESPONSE_H
+#define DHT_API_RESPONSE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "message_data.h"
+
+namespace api
+{
+    /**
+     * @brief
+     * A response that is to be written back to the client.
+     * The bytes are kept in separate segments (e.g. header, key and value), so that they can be handed to the
+     * socket as a gather list, without having to concatenate them into one buffer first.
+     */
+    class Response
+    {
+    public:
+        Response() = default;
+        Response(std::vector<uint8_t> bytes); // NOLINT
+        Response(const MessageData &message); // NOLINT
+
+        /**
+         * @brief Build a DHT_SUCCESS response, with header, key and value in separate segments.
+         */
+        static Response success(std::vector<uint8_t> key, std::vector<uint8_t> value);
+
+        Response &append(std::vector<uint8_t> segment);
+
+        [[nodiscard]] bool empty() const;
+        /**
+         * @return Total amount of bytes over all segments.
+         */
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] const std::vector<std::vector<uint8_t>> &segments() const;
+
+        /**
+         * @brief Concatenate all segments. Only meant for logging and testing, since it copies everything.
+         */
+        explicit operator std::vector<uint8_t>() const;
+
+    private:
+        std::vector<std::vector<uint8_t>> m_segments{};
+    };
+} // namespace api
+
+#endif //DHT_API_RESPONSE_H
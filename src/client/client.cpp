@@ -0,0 +1,269 @@
+#include "client.h"
+#include <deque>
+#include <stdexcept>
+#include <utility>
+#include <constants.h>
+#include <message_data.h>
+#include <parser.h>
+
+using client::Client;
+using client::Result;
+using asio::ip::tcp;
+
+namespace
+{
+    constexpr std::size_t key_size = 32;
+}
+
+class Client::Connection
+{
+public:
+    Connection(asio::io_context &io, const tcp::resolver::results_type &endpoints, uint64_t pipeline) :
+        m_socket(io),
+        m_pipeline(pipeline)
+    {
+        asio::connect(m_socket, endpoints);
+        // Pipelined requests are small, they should not wait for each other in the kernel.
+        m_socket.set_option(tcp::no_delay(true));
+    }
+
+    void start()
+    {
+        start_read();
+    }
+
+    void get(std::vector<uint8_t> bytes, get_handler_t handler)
+    {
+        if (!m_socket.is_open()) {
+            handler(Result{});
+            return;
+        }
+        if (m_inFlight.size() >= m_pipeline) {
+            m_heldBack.emplace_back(std::move(bytes), std::move(handler));
+            return;
+        }
+        m_inFlight.push_back(std::move(handler));
+        queue_write(std::move(bytes), {});
+    }
+
+    void put(std::vector<uint8_t> bytes, put_handler_t handler)
+    {
+        if (!m_socket.is_open()) {
+            if (handler) handler(false);
+            return;
+        }
+        queue_write(std::move(bytes), std::move(handler));
+    }
+
+    void close()
+    {
+        asio::error_code ec;
+        m_socket.close(ec);
+    }
+
+private:
+    struct Pending
+    {
+        std::vector<uint8_t> bytes;
+        put_handler_t written;
+    };
+
+    void queue_write(std::vector<uint8_t> bytes, put_handler_t written)
+    {
+        m_writeQueue.push_back({std::move(bytes), std::move(written)});
+        if (!m_writeInProgress)
+            start_write();
+    }
+
+    void start_write() // NOLINT
+    {
+        if (m_writeQueue.empty() || !m_socket.is_open()) {
+            m_writeInProgress = false;
+            return;
+        }
+
+        // Requests that were issued while the last write was in progress go out together.
+        m_writeInProgress = true;
+        m_writing.swap(m_writeQueue);
+        m_gather.clear();
+        for (const auto &pending: m_writing)
+            m_gather.push_back(asio::buffer(pending.bytes));
+
+        asio::async_write(m_socket, m_gather, [this](const asio::error_code &error, std::size_t) { // NOLINT
+            for (auto &pending: m_writing)
+                if (pending.written) pending.written(!error);
+            m_writing.clear();
+
+            if (error) {
+                fail();
+                return;
+            }
+            start_write();
+        });
+    }
+
+    void start_read() // NOLINT
+    {
+        asio::async_read(
+            m_socket,
+            asio::buffer(m_data.data(), sizeof(api::MessageHeader::MessageHeaderRaw)),
+            [this](const asio::error_code &error, std::size_t) { // NOLINT
+                if (error) {
+                    fail();
+                    return;
+                }
+                finish_read();
+            });
+    }
+
+    void finish_read() // NOLINT
+    {
+        api::MessageHeader header(reinterpret_cast<api::MessageHeader::MessageHeaderRaw &>(m_data[0]));
+        if (api::parser::validateHeader(header) != api::parser::Status::OK) {
+            fail();
+            return;
+        }
+
+        asio::async_read(
+            m_socket,
+            asio::buffer(m_data.data() + sizeof(api::MessageHeader::MessageHeaderRaw),
+                         header.size - sizeof(api::MessageHeader::MessageHeaderRaw)),
+            [this, header](const asio::error_code &error, std::size_t) { // NOLINT
+                api::parser::Frame frame{};
+                if (error ||
+                    api::parser::parse(std::span<const uint8_t>(m_data.data(), header.size), frame) != api::parser::Status::OK) {
+                    fail();
+                    return;
+                }
+
+                Result result{};
+                if (header.msg_type == util::constants::DHT_SUCCESS) {
+                    result.status = Result::Status::SUCCESS;
+                    result.value.assign(frame.value.begin(), frame.value.end());
+                } else if (header.msg_type == util::constants::DHT_FAILURE) {
+                    result.status = Result::Status::FAILURE;
+                } else {
+                    // Only GET is answered, anything else means the responses can no longer be matched to requests.
+                    fail();
+                    return;
+                }
+
+                if (m_inFlight.empty()) {
+                    fail();
+                    return;
+                }
+                auto handler = std::move(m_inFlight.front());
+                m_inFlight.pop_front();
+                handler(std::move(result));
+
+                while (!m_heldBack.empty() && m_inFlight.size() < m_pipeline) {
+                    auto [bytes, next] = std::move(m_heldBack.front());
+                    m_heldBack.pop_front();
+                    get(std::move(bytes), std::move(next));
+                }
+
+                start_read();
+            });
+    }
+
+    /**
+     * @brief Closes the connection and completes every outstanding GET as disconnected.
+     */
+    void fail()
+    {
+        close();
+        auto inFlight = std::move(m_inFlight);
+        auto heldBack = std::move(m_heldBack);
+        m_inFlight.clear();
+        m_heldBack.clear();
+        for (auto &handler: inFlight)
+            handler(Result{});
+        for (auto &[bytes, handler]: heldBack)
+            handler(Result{});
+        // Buffers that are being written stay alive until the write's handler ran.
+        auto unwritten = std::move(m_writeQueue);
+        m_writeQueue.clear();
+        for (auto &pending: unwritten)
+            if (pending.written) pending.written(false);
+    }
+
+    tcp::socket m_socket;
+    const uint64_t m_pipeline;
+
+    /// Handlers of the GET requests that were sent, in the order in which the responses will arrive.
+    std::deque<get_handler_t> m_inFlight{};
+    std::deque<std::pair<std::vector<uint8_t>, get_handler_t>> m_heldBack{};
+
+    std::deque<Pending> m_writeQueue{};
+    std::deque<Pending> m_writing{};
+    std::vector<asio::const_buffer> m_gather{};
+    bool m_writeInProgress{false};
+
+    std::vector<uint8_t> m_data = std::vector<uint8_t>(UINT16_MAX, 0);
+};
+
+Client::Client(const Options &o) :
+    m_options(o)
+{
+    tcp::resolver resolver(m_io);
+    auto endpoints = resolver.resolve(m_options.host, std::to_string(m_options.port));
+    for (uint64_t i = 0; i < std::max<uint64_t>(1, m_options.connections); ++i)
+        m_connections.push_back(std::make_unique<Connection>(m_io, endpoints, std::max<uint64_t>(1, m_options.pipeline)));
+    for (auto &connection: m_connections)
+        connection->start();
+
+    m_work.emplace(m_io.get_executor());
+    m_serviceFuture = std::async(std::launch::async, [this]() { m_io.run(); });
+}
+
+Client::~Client()
+{
+    asio::post(m_io, [this]() {
+        for (auto &connection: m_connections)
+            connection->close();
+    });
+    m_work.reset();
+    m_serviceFuture.wait();
+    m_connections.clear();
+}
+
+Client::Connection &Client::next()
+{
+    return *m_connections[m_next++ % m_connections.size()];
+}
+
+void Client::get(std::vector<uint8_t> key, get_handler_t handler)
+{
+    if (key.size() != key_size)
+        throw std::invalid_argument("key must be " + std::to_string(key_size) + " bytes long");
+
+    auto bytes = api::Message_KEY(util::constants::DHT_GET, key).m_bytes;
+    asio::post(m_io, [&connection(next()), bytes(std::move(bytes)), handler(std::move(handler))]() mutable {
+        connection.get(std::move(bytes), std::move(handler));
+    });
+}
+
+std::future<Result> Client::get(std::vector<uint8_t> key)
+{
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future();
+    get(std::move(key), [promise](Result result) {
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+void Client::put(std::vector<uint8_t> key, std::vector<uint8_t> value, put_handler_t handler,
+                 uint16_t ttl, uint8_t replication)
+{
+    if (key.size() != key_size)
+        throw std::invalid_argument("key must be " + std::to_string(key_size) + " bytes long");
+    if (sizeof(api::MessageHeader::MessageHeaderRaw) + sizeof(api::MessageHeaderExtend::MessageHeaderRaw) +
+        key.size() + value.size() > UINT16_MAX)
+        throw std::invalid_argument("value too large");
+
+    auto bytes = api::Message_DHT_PUT(key, value, ttl, replication).m_bytes;
+    asio::post(m_io, [&connection(next()), bytes(std::move(bytes)), handler(std::move(handler))]() mutable {
+        connection.put(std::move(bytes), std::move(handler));
+    });
+}
@@ -0,0 +1,92 @@
+#ifndef DHT_CLIENT_H
+#define DHT_CLIENT_H
+
+#include <asio.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <optional>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+namespace client
+{
+    struct Options
+    {
+        std::string host = "127.0.0.1";
+        uint16_t port = 7002;
+        /// Requests are spread round-robin over this many connections.
+        uint64_t connections = 1;
+        /// Maximum number of GET requests per connection that wait for their response at the same time.
+        /// Further requests are held back until a response arrives.
+        uint64_t pipeline = 16;
+    };
+
+    struct Result
+    {
+        enum class Status
+        {
+            SUCCESS,
+            FAILURE,
+            /// The connection was closed before the response arrived.
+            DISCONNECTED
+        };
+
+        Status status{Status::DISCONNECTED};
+        std::vector<uint8_t> value{};
+    };
+
+    /**
+     * @brief
+     * Client for the DHT_PUT / DHT_GET api. Requests are pipelined: they are written as soon as they are issued,
+     * and the server answers them in order.
+     * Handlers are called on the client's io thread and must not block.
+     */
+    class Client
+    {
+    public:
+        using get_handler_t = std::function<void(Result result)>;
+        /// Called once the request was written, DHT_PUT has no response. false if the connection was closed first.
+        using put_handler_t = std::function<void(bool written)>;
+
+        /**
+         * @brief Connects all connections before returning.
+         * @throws asio::system_error if a connection can not be established
+         */
+        explicit Client(const Options &o = {});
+        ~Client();
+
+        Client(const Client &other) = delete;
+        Client &operator=(const Client &other) = delete;
+
+        /**
+         * @throws std::invalid_argument if the key is not 32 bytes long
+         */
+        void get(std::vector<uint8_t> key, get_handler_t handler);
+        std::future<Result> get(std::vector<uint8_t> key);
+
+        /**
+         * @throws std::invalid_argument if the key is not 32 bytes long, or the message would be too large
+         */
+        void put(std::vector<uint8_t> key, std::vector<uint8_t> value, put_handler_t handler = {},
+                 uint16_t ttl = 0, uint8_t replication = 0);
+
+    private:
+        class Connection;
+
+        Connection &next();
+
+        const Options m_options;
+
+        asio::io_context m_io{};
+        std::optional<asio::executor_work_guard<asio::io_context::executor_type>> m_work{};
+        std::future<void> m_serviceFuture{};
+
+        std::vector<std::unique_ptr<Connection>> m_connections{};
+        std::atomic<std::size_t> m_next{0};
+    };
+} // namespace client
+
+#endif //DHT_CLIENT_H
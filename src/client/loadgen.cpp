@@ -0,0 +1,235 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <cxxopts.hpp>
+#include "client.h"
+
+/*
+ * Drives a mixed DHT_PUT / DHT_GET workload against a running api and reports throughput and latency percentiles.
+ * Every connection keeps `pipeline` requests outstanding (closed loop): each completed request issues the next one.
+ */
+
+using namespace std::chrono_literals;
+using clock_type = std::chrono::steady_clock;
+
+namespace
+{
+    struct Workload
+    {
+        uint64_t keys;
+        uint64_t value_size;
+        double get_ratio;
+        uint16_t ttl;
+    };
+
+    class LoadGenerator
+    {
+    public:
+        LoadGenerator(client::Client &client, const Workload &workload) :
+            m_client(client), m_workload(workload)
+        {
+            std::uniform_int_distribution<int> byte(0, 255);
+            m_value.resize(m_workload.value_size);
+            for (auto &b: m_value)
+                b = static_cast<uint8_t>(byte(m_random));
+        }
+
+        void issue()
+        {
+            std::vector<uint8_t> key(32, 0);
+            bool isGet;
+            {
+                std::scoped_lock lock(m_mutex);
+                if (m_stopped)
+                    return;
+                ++m_outstanding;
+                auto index = std::uniform_int_distribution<uint64_t>(0, m_workload.keys - 1)(m_random);
+                for (size_t i = 0; i < sizeof(index); ++i)
+                    key[i] = static_cast<uint8_t>(index >> (8 * i));
+                isGet = std::bernoulli_distribution(m_workload.get_ratio)(m_random);
+            }
+
+            auto started = clock_type::now();
+            if (isGet) {
+                m_client.get(std::move(key), [this, started](client::Result result) {
+                    done(m_gets, started, result.status);
+                });
+            } else {
+                m_client.put(std::move(key), m_value, [this, started](bool written) {
+                    done(m_puts, started, written ? client::Result::Status::SUCCESS
+                                                  : client::Result::Status::DISCONNECTED);
+                }, m_workload.ttl);
+            }
+        }
+
+        /**
+         * @brief Stop issuing requests and wait for the outstanding ones.
+         */
+        void stop(std::chrono::seconds timeout)
+        {
+            std::unique_lock lock(m_mutex);
+            m_stopped = true;
+            m_drained.wait_for(lock, timeout, [this]() { return m_outstanding == 0; });
+        }
+
+        void report(std::chrono::duration<double> elapsed)
+        {
+            std::scoped_lock lock(m_mutex);
+            auto total = m_gets.latencies.size() + m_puts.latencies.size();
+            std::cout << "requests:   " << total << " in " << std::fixed << std::setprecision(2) << elapsed.count() << "s"
+                      << std::endl
+                      << "throughput: " << std::setprecision(0) << static_cast<double>(total) / elapsed.count()
+                      << " requests/s" << std::endl << std::endl;
+
+            std::cout << std::setw(6) << "op" << std::setw(10) << "count" << std::setw(10) << "success"
+                      << std::setw(10) << "failure" << std::setw(10) << "lost"
+                      << std::setw(12) << "p50 [us]" << std::setw(12) << "p99 [us]" << std::setw(12) << "p999 [us]"
+                      << std::endl;
+            print("GET", m_gets);
+            print("PUT", m_puts);
+        }
+
+    private:
+        struct Stats
+        {
+            std::vector<double> latencies{};
+            uint64_t success{0}, failure{0}, disconnected{0};
+        };
+
+        void done(Stats &stats, clock_type::time_point started, client::Result::Status status)
+        {
+            {
+                std::scoped_lock lock(m_mutex);
+                stats.latencies.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - started).count());
+                switch (status) {
+                    case client::Result::Status::SUCCESS: ++stats.success; break;
+                    case client::Result::Status::FAILURE: ++stats.failure; break;
+                    case client::Result::Status::DISCONNECTED: ++stats.disconnected; break;
+                }
+                if (--m_outstanding == 0 && m_stopped)
+                    m_drained.notify_all();
+            }
+            if (status != client::Result::Status::DISCONNECTED)
+                issue();
+        }
+
+        static void print(const std::string &name, Stats &stats)
+        {
+            auto percentile = [&](double p) {
+                if (stats.latencies.empty())
+                    return 0.0;
+                auto index = std::min(stats.latencies.size() - 1,
+                                      static_cast<size_t>(p * static_cast<double>(stats.latencies.size())));
+                std::nth_element(stats.latencies.begin(), stats.latencies.begin() + static_cast<long>(index),
+                                 stats.latencies.end());
+                return stats.latencies[index];
+            };
+            std::cout << std::setw(6) << name << std::setw(10) << stats.latencies.size()
+                      << std::setw(10) << stats.success << std::setw(10) << stats.failure
+                      << std::setw(10) << stats.disconnected << std::setprecision(0)
+                      << std::setw(12) << percentile(0.5) << std::setw(12) << percentile(0.99)
+                      << std::setw(12) << percentile(0.999) << std::endl;
+        }
+
+        client::Client &m_client;
+        const Workload m_workload;
+        std::vector<uint8_t> m_value{};
+
+        std::mutex m_mutex{};
+        std::condition_variable m_drained{};
+        std::mt19937_64 m_random{std::random_device{}()};
+        uint64_t m_outstanding{0};
+        bool m_stopped{false};
+        Stats m_gets{}, m_puts{};
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    cxxopts::Options options("dht-loadgen", "Load generator for the DHT api");
+    options.add_options()
+        (
+            "a,address", "Address of the api",
+            cxxopts::value<std::string>()->default_value("127.0.0.1")
+        )
+        (
+            "p,port", "Port of the api",
+            cxxopts::value<uint16_t>()->default_value("7002")
+        )
+        (
+            "c,connections", "Number of connections",
+            cxxopts::value<uint64_t>()->default_value("4")
+        )
+        (
+            "n,pipeline", "Outstanding requests per connection",
+            cxxopts::value<uint64_t>()->default_value("16")
+        )
+        (
+            "d,duration", "Seconds to run",
+            cxxopts::value<uint64_t>()->default_value("10")
+        )
+        (
+            "g,get-ratio", "Fraction of requests that are DHT_GET, the rest are DHT_PUT",
+            cxxopts::value<double>()->default_value("0.9")
+        )
+        (
+            "k,keys", "Number of distinct keys. Keys are always 32 bytes, as required by the protocol",
+            cxxopts::value<uint64_t>()->default_value("1000")
+        )
+        (
+            "v,value-size", "Size of the values in bytes",
+            cxxopts::value<uint64_t>()->default_value("128")
+        )
+        (
+            "t,ttl", "Time to live of stored values in seconds, 0 for the default",
+            cxxopts::value<uint16_t>()->default_value("0")
+        )
+        ("h,help", "Print usage");
+    auto args = options.parse(argc, argv);
+
+    if (args.count("help")) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    Workload workload{
+        .keys= std::max<uint64_t>(1, args["keys"].as<uint64_t>()),
+        .value_size= args["value-size"].as<uint64_t>(),
+        .get_ratio= std::clamp(args["get-ratio"].as<double>(), 0.0, 1.0),
+        .ttl= args["ttl"].as<uint16_t>()
+    };
+    client::Options clientOptions{
+        .host= args["address"].as<std::string>(),
+        .port= args["port"].as<uint16_t>(),
+        .connections= std::max<uint64_t>(1, args["connections"].as<uint64_t>()),
+        .pipeline= std::max<uint64_t>(1, args["pipeline"].as<uint64_t>())
+    };
+    std::chrono::seconds duration(args["duration"].as<uint64_t>());
+
+    try {
+        auto dhtClient = std::make_unique<client::Client>(clientOptions);
+        LoadGenerator generator(*dhtClient, workload);
+
+        auto started = clock_type::now();
+        for (uint64_t i = 0; i < clientOptions.connections * clientOptions.pipeline; ++i)
+            generator.issue();
+        std::this_thread::sleep_for(duration);
+        generator.stop(10s);
+        generator.report(clock_type::now() - started);
+        // Requests that are still outstanding complete as disconnected, while the generator still exists.
+        dhtClient.reset();
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
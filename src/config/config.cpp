@@ -2,6 +2,8 @@
 #include <inipp.h>
 #include <fstream>
 #include <regex>
+#include <algorithm>
+#include <bit>
 
 // Define static variables
 uint8_t config::Configuration::PoW_Difficulty{DEFAULT_DIFFICULTY};
@@ -54,6 +56,61 @@ config::Configuration config::parseConfigFile(const std::string &path)
         splitIP(str, config.bootstrapNode_address, config.bootstrapNode_port);
     if (inipp::get_value(ini.sections["dht"], "node_amount", uint64))
         config.node_amount = uint64;
+    if (inipp::get_value(ini.sections["dht"], "api_threads", uint64))
+        config.api_threads = uint64;
+    if (inipp::get_value(ini.sections["dht"], "api_max_connections", uint64))
+        config.api_max_connections = uint64;
+    if (inipp::get_value(ini.sections["dht"], "api_idle_timeout", uint64))
+        config.api_idle_timeout = uint64;
+    if (inipp::get_value(ini.sections["dht"], "fix_fingers_min_interval", uint64))
+        config.fix_fingers_min_interval = uint64;
+    if (inipp::get_value(ini.sections["dht"], "fix_fingers_max_interval", uint64))
+        config.fix_fingers_max_interval = std::max(uint64, config.fix_fingers_min_interval);
+    if (inipp::get_value(ini.sections["dht"], "finger_base", uint64) && uint64 >= 2 && uint64 <= 256 &&
+        std::has_single_bit(uint64))
+        config.finger_base = uint64;
+    if (inipp::get_value(ini.sections["dht"], "pns_candidates", uint64))
+        config.pns_candidates = std::max<uint64_t>(1, uint64);
+    if (inipp::get_value(ini.sections["dht"], "lookup_cache_size", uint64))
+        config.lookup_cache_size = uint64;
+    if (inipp::get_value(ini.sections["dht"], "value_cache_size", uint64))
+        config.value_cache_size = uint64;
+    if (inipp::get_value(ini.sections["dht"], "value_cache_max_staleness", uint64))
+        config.value_cache_max_staleness = uint64;
+    if (inipp::get_value(ini.sections["dht"], "full_membership", boolean))
+        config.full_membership = boolean;
+    if (inipp::get_value(ini.sections["dht"], "gossip_size", uint64))
+        config.gossip_size = std::max<uint64_t>(1, uint64);
+    if (inipp::get_value(ini.sections["dht"], "vnodes", uint64))
+        config.vnodes = std::clamp<uint64_t>(uint64, 1, 256);
+    if (inipp::get_value(ini.sections["dht"], "rebalance_interval", uint64))
+        config.rebalance_interval = uint64;
+    if (inipp::get_value(ini.sections["dht"], "rebalance_ratio", uint64))
+        config.rebalance_ratio = std::max<uint64_t>(2, uint64);
+    if (inipp::get_value(ini.sections["dht"], "rebalance_max_bytes", uint64))
+        config.rebalance_max_bytes = uint64;
+    if (inipp::get_value(ini.sections["dht"], "load_metric", str) && (str == "bytes" || str == "requests"))
+        config.load_metric = str;
+    if (inipp::get_value(ini.sections["dht"], "neighbor_cache_size", uint64))
+        config.neighbor_cache_size = uint64;
+    if (inipp::get_value(ini.sections["dht"], "successor_list_size", uint64))
+        config.successor_list_size = std::max<uint64_t>(1, uint64);
+    if (inipp::get_value(ini.sections["dht"], "rpc_timeout", uint64))
+        config.rpc_timeout = std::max<uint64_t>(1, uint64);
+    if (inipp::get_value(ini.sections["dht"], "lookup_timeout", uint64))
+        config.lookup_timeout = std::max(uint64, config.rpc_timeout);
+    if (inipp::get_value(ini.sections["dht"], "peer_alive_for", uint64))
+        config.peer_alive_for = uint64;
+    if (inipp::get_value(ini.sections["dht"], "peer_dead_after", uint64))
+        config.peer_dead_after = std::max<uint64_t>(1, uint64);
+    if (inipp::get_value(ini.sections["dht"], "lookup_method", str) &&
+        (str == "local" || str == "pass_on" || str == "direct"))
+        config.lookup_method = str;
+    if (inipp::get_value(ini.sections["dht"], "verify_successor", str) &&
+        (str == "always" || str == "sampled" || str == "final_hop" || str == "never"))
+        config.verify_successor = str;
+    if (inipp::get_value(ini.sections["dht"], "verify_sample_percent", uint64))
+        config.verify_sample_percent = std::min<uint64_t>(100, uint64);
     if (inipp::get_value(ini.sections["dht"], "startup_script", str))
         config.startup_script = str;
     return config;
@@ -24,6 +24,65 @@ namespace config
         std::string bootstrapNode_address{"127.0.0.1"};
         uint16_t bootstrapNode_port{6002};
         uint64_t node_amount{1};
+        /// Number of threads serving the api of each node.
+        uint64_t api_threads{1};
+        /// Maximum number of api clients per node.
+        uint64_t api_max_connections{1024};
+        /// Seconds after which idle api clients are disconnected, 0 to keep them forever.
+        uint64_t api_idle_timeout{300};
+        /// Milliseconds between finger lookups while the ring changes.
+        uint64_t fix_fingers_min_interval{100};
+        /// Milliseconds between finger lookups once the ring is stable.
+        uint64_t fix_fingers_max_interval{4000};
+        /// Base of the finger table, a power of two. Base b keeps b-1 fingers per digit of the id, which takes
+        /// log_b(N) instead of log_2(N) hops.
+        uint64_t finger_base{2};
+        /// Nodes a finger is chosen from by round trip time, 1 to always use the successor of the finger's start.
+        uint64_t pns_candidates{4};
+        /// Nodes whose responsibility for recently looked up keys is remembered, 0 to look up every key.
+        uint64_t lookup_cache_size{1024};
+        /// Values of recently read keys this node serves without asking the responsible node, 0 disables the cache.
+        uint64_t value_cache_size{0};
+        /// Milliseconds for which a cached value is served at most, writes through other nodes are seen after this.
+        uint64_t value_cache_max_staleness{1000};
+        /// Whether every node knows every other node, so that lookups take no RPC. Meant for rings of up to a few
+        /// hundred nodes, the membership is spread by gossip on stabilize and notify.
+        bool full_membership{false};
+        /// Membership entries piggybacked on one message with full_membership.
+        uint64_t gossip_size{16};
+        /// Ring positions this process takes, all served by one server and sharing one data store. A host with
+        /// more capacity takes more, its share of the keys grows with the count.
+        uint64_t vnodes{1};
+        /// Milliseconds between comparisons of a node's load with its predecessor's, 0 disables load balancing. An
+        /// overloaded node asks its predecessor to move into its arc, which needs vnodes above 1: only vnodes other
+        /// than 0 move. Every node gives or takes at most one move per interval.
+        uint64_t rebalance_interval{0};
+        /// A node is overloaded once its load is more than rebalance_ratio times the load of its predecessor.
+        uint64_t rebalance_ratio{2};
+        /// Most bytes of data one move transfers. With rebalance_interval, this bounds the migration bandwidth.
+        uint64_t rebalance_max_bytes{1 << 20};
+        /// What the load of a node is: bytes (stored in its arc) or requests (for data, per rebalance_interval).
+        std::string load_metric{"bytes"};
+        /// Nodes met during lookups that are routed to like fingers, 0 to route by the fingers only.
+        uint64_t neighbor_cache_size{32};
+        /// Number of successors each node keeps to replace a failed successor.
+        uint64_t successor_list_size{8};
+        /// Milliseconds after which a single RPC to a peer is given up.
+        uint64_t rpc_timeout{1000};
+        /// Milliseconds after which a whole lookup, over all of its hops, is given up.
+        uint64_t lookup_timeout{5000};
+        /// Milliseconds for which a peer that answered is considered alive without asking it again.
+        uint64_t peer_alive_for{1000};
+        /// Failed RPCs in a row after which a peer is considered dead and removed from the routing table.
+        uint64_t peer_dead_after{3};
+        /// How lookups are routed: local (iterative), pass_on (recursive) or direct (recursive, the responsible node
+        /// answers the originator).
+        std::string lookup_method{"local"};
+        /// Which successors returned by a hop of a local lookup are verified with an extra RPC: always, sampled,
+        /// final_hop or never.
+        std::string verify_successor{"final_hop"};
+        /// Percentage of final hops that are verified with verify_successor = sampled.
+        uint64_t verify_sample_percent{10};
         std::optional<std::string> startup_script{};
         static uint8_t PoW_Difficulty;
         static uint8_t defaultReplicationLimit;
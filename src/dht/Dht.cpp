@@ -3,6 +3,8 @@
 #include <capnp/message.h>
 #include <capnp/serialize-packed.h>
 #include <capnp/ez-rpc.h>
+#include <kj/vector.h>
+#include <algorithm>
 #include "logging/centralLogControl.h"
 
 #ifndef LOG_ERR
@@ -12,10 +14,25 @@
 using dht::Dht;
 using namespace std::chrono_literals;
 
+namespace
+{
+    constexpr std::chrono::milliseconds stabilize_interval = 1s;
+    constexpr std::chrono::milliseconds check_predecessor_interval = 1s;
+
+    struct PredecessorReply
+    {
+        /// false if the successor did not answer.
+        bool reachable{false};
+        std::optional<NodeInformation::Node> predecessor{};
+        std::vector<NodeInformation::Node> successors{};
+    };
+}
+
 void Dht::runServer()
 {
-    auto peerImpl = kj::heap<PeerImpl>(m_nodeInformation, m_conf);
-    m_peerImpl = *peerImpl;
+    auto peerImpl = makePeerImpl();
+    for (auto &vnode: m_vnodes)
+        peerImpl->addVnode(vnode->makePeerImpl());
     auto peerServer = rpc::getServer(
         m_conf,
         std::move(peerImpl),
@@ -26,26 +43,68 @@ void Dht::runServer()
 
     // from kj/async.h - Use `kj::getCurrentThreadExecutor()` to get an executor that schedules calls on the current
     // thread's event loop.
-    // Here we make sure every node runs on its own thread which has its own event loop.
-    m_executor.emplace(kj::getCurrentThreadExecutor());
-
-    // It seems like promises are atomic in the event loop. So no *actual* asynchronous execution... Threads it is then
-    auto f = std::async(std::launch::async, [this]() {
-        mainLoop();
-    });
+    // Here we make sure every node runs on its own thread which has its own event loop. Vnodes share the thread of
+    // their host.
+    std::vector<Dht *> nodes{this};
+    for (auto &vnode: m_vnodes)
+        nodes.push_back(vnode.get());
+
+    // Maintenance runs on this event loop, joining blocks and gets its own thread.
+    kj::Vector<kj::Promise<void>> maintenance{};
+    std::vector<std::future<void>> mainLoops{};
+    for (auto *node: nodes) {
+        node->m_executor.emplace(kj::getCurrentThreadExecutor());
+        node->m_timer.emplace(peerServer->getIoProvider().getTimer());
+        node->scheduleMaintenance(maintenance);
+        mainLoops.push_back(std::async(std::launch::async, [node]() {
+            node->mainLoop();
+        }));
+    }
 
-    while (!m_mainLoopExited) {
+    while (!std::all_of(nodes.begin(), nodes.end(), [](Dht *node) { return node->m_mainLoopExited.load(); })) {
         waitScope.poll();
     }
 
-    m_peerImpl.reset();
+    maintenance.clear();
+    for (auto *node: nodes) {
+        node->m_timer.reset();
+        node->m_peerImpl.reset();
+    }
+}
+
+kj::Own<dht::PeerImpl> Dht::makePeerImpl()
+{
+    auto method = m_conf.lookup_method == "pass_on" ? PeerImpl::GetSuccessorMethod::PASS_ON
+                  : m_conf.lookup_method == "direct" ? PeerImpl::GetSuccessorMethod::DIRECT
+                  : PeerImpl::GetSuccessorMethod::LOCAL;
+    auto peerImpl = kj::heap<PeerImpl>(m_nodeInformation, m_conf, m_failureDetector, m_membership, method);
+    // The fingers were looked up for the old position.
+    peerImpl->setOnMove([this]() { m_fingerScheduler.churn(); });
+    m_peerImpl = *peerImpl;
+    return peerImpl;
+}
+
+void Dht::scheduleMaintenance(kj::Vector<kj::Promise<void>> &maintenance)
+{
+    maintenance.add(schedule("stabilize", []() { return stabilize_interval; }, [this]() { return stabilize(); }));
+    maintenance.add(schedule("checkPredecessor", []() { return check_predecessor_interval; },
+                             [this]() { return checkPredecessor(); }));
+    maintenance.add(schedule("fixFingers", [this]() { return m_fingerScheduler.interval(); },
+                             [this]() { return fixFingers(); }));
+    if (!m_digitOffsets.empty()) {
+        maintenance.add(schedule("fixDigitFingers", [this]() { return m_fingerScheduler.interval(); },
+                                 [this]() { return fixDigitFingers(); }));
+    }
+    if (m_conf.rebalance_interval > 0) {
+        auto interval = std::chrono::milliseconds(m_conf.rebalance_interval);
+        maintenance.add(schedule("rebalance", [interval]() { return interval; }, [this]() { return rebalance(); }));
+    }
 }
 
 void Dht::mainLoop()
 {
     /*
-     * This is where the dht will fix fingers, store and retrieve data, etc.
-     * This needs to be thread-safe, and needs to be able to exit at any time.
+     * Needs to be thread-safe, and needs to be able to exit at any time.
      * (No blocking function calls in here, at least not for too long)
      */
 
@@ -63,13 +122,6 @@ void Dht::mainLoop()
                 create();
             }
         }
-
-        if (m_dhtCancelled) break;
-        stabilize();
-        if (m_dhtCancelled) break;
-        fixFingers();
-        if (m_dhtCancelled) break;
-        checkPredecessor();
         if (m_dhtCancelled) break;
 
         // Wait one second
@@ -80,6 +132,22 @@ void Dht::mainLoop()
     m_mainLoopExited = true;
 }
 
+kj::Promise<void> Dht::schedule(const char *name, std::function<std::chrono::milliseconds()> interval,
+                                std::function<kj::Promise<void>()> task)
+{
+    auto delay = static_cast<int64_t>(
+        static_cast<double>(interval().count()) * std::uniform_real_distribution<double>(0.75, 1.25)(m_random));
+    return m_timer.value().get().afterDelay(delay * kj::MILLISECONDS).then([task]() {
+        return task();
+    }).then([]() {}, [name](kj::Exception &&e) {
+        SPDLOG_DEBUG("{} failed:\n\t\t{}", name, e.getDescription().cStr());
+    }).then([this, name, interval(std::move(interval)), task(std::move(task))]() mutable {
+        if (m_dhtCancelled)
+            return kj::Promise<void>(kj::READY_NOW);
+        return schedule(name, std::move(interval), std::move(task));
+    });
+}
+
 void Dht::setApi(std::unique_ptr<api::Api> api)
 {
     // Destroy old api (This is in two statements for easier debugging):
@@ -108,6 +176,11 @@ void Dht::setApi(std::unique_ptr<api::Api> api)
 
 std::optional<NodeInformation::Node> Dht::getSuccessor(NodeInformation::id_type key)
 {
+    // One hop: with every member known, the responsible node is looked up in memory. Until the membership was
+    // copied on join, this node only knows itself and routes instead.
+    if (m_membership && m_membership->size() > 1)
+        return m_membership->successor(key);
+
     auto started = std::chrono::system_clock::now();
     capnp::EzRpcClient client(m_nodeInformation->getIp(), m_nodeInformation->getPort());
     auto cap = client.getMain<Peer>();
@@ -124,8 +197,10 @@ std::optional<NodeInformation::Node> Dht::getSuccessor(NodeInformation::id_type
     return ret;
 }
 
-std::vector<uint8_t> Dht::onDhtPut(const api::Message_DHT_PUT &message_data, std::atomic_bool &cancelled)
+api::Response Dht::onDhtPut(const api::Message_DHT_PUT &message_data, std::atomic_bool &cancelled)
 {
+    (void) cancelled;
+
     SPDLOG_INFO(
         "DHT PUT\n"
         "\t\tsize:        {}\n"
@@ -151,12 +226,14 @@ std::vector<uint8_t> Dht::onDhtPut(const api::Message_DHT_PUT &message_data, std
                ? std::chrono::seconds(message_data.m_headerExtend.ttl)
                : std::chrono::system_clock::duration::max();
 
-    auto successor = getSuccessor(finalHashedKey);
+    // Reads through this node see the new value right away.
+    m_valueCache.erase(message_data.key);
+    auto successor = onResponsible(finalHashedKey, [&](const NodeInformation::Node &node) {
+        return getPeerImpl().setData(node, message_data.key, message_data.value, message_data.m_headerExtend.ttl);
+    }).first;
 
     if (successor) {
         SPDLOG_DEBUG("Successor found: {}:{}", successor->getIp(), successor->getPort());
-        getPeerImpl().setData(*successor, message_data.key, message_data.value,
-                              message_data.m_headerExtend.ttl);
     } else {
         SPDLOG_DEBUG("No Successor found!");
     }
@@ -205,12 +282,11 @@ std::vector<uint8_t> Dht::onDhtPut(const api::Message_DHT_PUT &message_data, std
         });
     }
 
-    for (uint8_t i{0}; !cancelled && i < 10; ++i)
-        std::this_thread::sleep_for(1s);
-    return message_data.m_bytes;
+    // DHT_PUT has no response, the client does not wait for one.
+    return {};
 }
 
-std::vector<uint8_t> Dht::onDhtGet(const api::Message_KEY &message_data, std::atomic_bool &cancelled)
+api::Response Dht::onDhtGet(const api::Message_KEY &message_data, std::atomic_bool &cancelled)
 {
     (void) cancelled;
 
@@ -222,17 +298,27 @@ std::vector<uint8_t> Dht::onDhtGet(const api::Message_KEY &message_data, std::at
         std::to_string(message_data.m_header.msg_type)
     );
 
+    if (auto cached = m_valueCache.find(message_data.key)) {
+        SPDLOG_DEBUG("Value found in the value cache");
+        return api::Response::success(message_data.key, std::move(*cached));
+    }
+
     // Hashing received key to convert it into length of 20 bytes
     std::string sKey{message_data.key.begin(), message_data.key.end()};
     NodeInformation::id_type finalHashedKey = util::hash_sha256(sKey);
 
-    auto successor = getSuccessor(finalHashedKey);
+    auto [successor, item] = onResponsible(finalHashedKey, [&](const NodeInformation::Node &node) {
+        return getPeerImpl().getDataExpires(node, message_data.key);
+    });
 
     std::optional<std::vector<uint8_t>> response{};
 
     if (successor) {
         SPDLOG_DEBUG("Successor found: {}:{}", successor->getIp(), successor->getPort());
-        response = getPeerImpl().getData(*successor, message_data.key);
+    }
+    if (item) {
+        m_valueCache.insert(message_data.key, item->first, item->second);
+        response = std::move(item->first);
     }
 
     if (!response && m_nodeInformation->getAverageReplicationIndex() >= 1) {
@@ -258,15 +344,17 @@ std::vector<uint8_t> Dht::onDhtGet(const api::Message_KEY &message_data, std::at
     }
 
     if (response) {
-        return api::Message_DHT_SUCCESS(message_data.key, *response);
+        return api::Response::success(message_data.key, std::move(*response));
     } else {
         return api::Message_KEY(util::constants::DHT_FAILURE, message_data.key);
     }
 }
 
-std::vector<uint8_t> Dht::onDhtPutKeyIsHashOfData(const api::Message_DHT_PUT_KEY_IS_HASH_OF_DATA &message_data,
-                                                  std::atomic_bool &cancelled)
+api::Response Dht::onDhtPutKeyIsHashOfData(const api::Message_DHT_PUT_KEY_IS_HASH_OF_DATA &message_data,
+                                           std::atomic_bool &cancelled)
 {
+    (void) cancelled;
+
     SPDLOG_INFO(
         "onDhtPutKeyIsHashOfData\n"
         "\t\tsize:        {}\n"
@@ -292,14 +380,14 @@ std::vector<uint8_t> Dht::onDhtPutKeyIsHashOfData(const api::Message_DHT_PUT_KEY
         ? std::chrono::seconds(message_data.m_headerExtend.ttl)
         : std::chrono::system_clock::duration::max();
 
-    auto successor = getSuccessor(finalHashedKey);
+    std::vector<uint8_t> vFinalHashedKey(finalHashedKey.size());
+    std::copy(finalHashedKey.begin(), finalHashedKey.end(), vFinalHashedKey.begin());
+    auto successor = onResponsible(finalHashedKey, [&](const NodeInformation::Node &node) {
+        return getPeerImpl().setData(node, vFinalHashedKey, message_data.value, message_data.m_headerExtend.ttl);
+    }).first;
 
     if (successor) {
         SPDLOG_DEBUG("Successor found: {}:{}", successor->getIp(), successor->getPort());
-        std::vector<uint8_t> vFinalHashedKey(finalHashedKey.size());
-        std::copy(finalHashedKey.begin(), finalHashedKey.end(), vFinalHashedKey.begin());
-        getPeerImpl().setData(*successor, vFinalHashedKey, message_data.value,
-                              message_data.m_headerExtend.ttl);
     } else {
         SPDLOG_DEBUG("No Successor found!");
     }
@@ -351,12 +439,11 @@ std::vector<uint8_t> Dht::onDhtPutKeyIsHashOfData(const api::Message_DHT_PUT_KEY
         });
     }
 
-    for (uint8_t i{0}; !cancelled && i < 10; ++i)
-        std::this_thread::sleep_for(1s);
-    return message_data.m_bytes;
+    // DHT_PUT has no response, the client does not wait for one.
+    return {};
 }
 
-std::vector<uint8_t> Dht::onDhtGetKeyIsHashOfData(const api::Message_DHT_GET_KEY_IS_HASH_OF_DATA &message_data,
+api::Response Dht::onDhtGetKeyIsHashOfData(const api::Message_DHT_GET_KEY_IS_HASH_OF_DATA &message_data,
                                                   std::atomic_bool &cancelled)
 {
     (void) cancelled;
@@ -373,19 +460,20 @@ std::vector<uint8_t> Dht::onDhtGetKeyIsHashOfData(const api::Message_DHT_GET_KEY
     NodeInformation::id_type finalHashedKey;
     std::copy(message_data.key.begin(), message_data.key.end(), finalHashedKey.begin());
 
-    auto successor = getSuccessor(finalHashedKey);
-
-    std::optional<std::vector<uint8_t>> response{};
+    auto [successor, response] = onResponsible(finalHashedKey, [&](const NodeInformation::Node &node) {
+        return getPeerImpl().getData(node, message_data.key);
+    });
 
     if (successor) {
         SPDLOG_DEBUG("Successor found: {}:{}", successor->getIp(), successor->getPort());
-        response = getPeerImpl().getData(*successor, message_data.key);
     }
 
-    std::string sResponse{response->begin(), response->end()};
-    auto hashOfValueGivenBySuccessor = util::hash_sha256(sResponse);
+    // Only a value that is present can be hashed, no responsible node may have answered.
+    auto matchesKey = [&finalHashedKey](const auto &value) {
+        return value && util::hash_sha256(std::string{value->begin(), value->end()}) == finalHashedKey;
+    };
 
-    if ((!response && m_nodeInformation->getAverageReplicationIndex() >= 1) || (hashOfValueGivenBySuccessor != finalHashedKey)) {
+    if ((!response && m_nodeInformation->getAverageReplicationIndex() >= 1) || (response && !matchesKey(response))) {
         /* Check if any of the replicated copies are present. */
         for (int i = 1; i <= m_nodeInformation->getAverageReplicationIndex(); ++i) {
             auto tempMessage_Data = message_data;
@@ -400,13 +488,8 @@ std::vector<uint8_t> Dht::onDhtGetKeyIsHashOfData(const api::Message_DHT_GET_KEY
                 SPDLOG_DEBUG("Successor found for replicated data: {}:{}", replicationSuccessor->getIp(),
                              replicationSuccessor->getPort());
                 response = m_peerImpl.value().get().getData(*replicationSuccessor, tempMessage_Data.key);
-                std::string sResponse{response->begin(), response->end()};
-                auto hashOfValueGivenBySuccessor = util::hash_sha256(sResponse);
-
-                if(hashOfValueGivenBySuccessor == finalHashedKey){
+                if (matchesKey(response)) {
                     break;
-                } else {
-                    continue;
                 }
             }
         }
@@ -415,7 +498,7 @@ std::vector<uint8_t> Dht::onDhtGetKeyIsHashOfData(const api::Message_DHT_GET_KEY
     }
 
     if (response) {
-        return api::Message_DHT_SUCCESS(message_data.key, *response);
+        return api::Response::success(message_data.key, std::move(*response));
     } else {
         return api::Message_KEY(util::constants::DHT_FAILURE, message_data.key);
     }
@@ -440,7 +523,7 @@ void Dht::join(const NodeInformation::Node &node)
     m_nodeInformation->setPredecessor();
 
     auto client = getPeerImpl().getClient(node.getIp(), node.getPort());
-    auto cap = client->getMain<Peer>();
+    auto cap = PeerImpl::getPeer(*client, node);
     auto req = cap.getPoWPuzzleOnJoinRequest();
     PeerImpl::buildNode(req.getNewNode(), m_nodeInformation->getNode());
 
@@ -480,7 +563,7 @@ void Dht::join(const NodeInformation::Node &node)
                       this->m_nodeInformation->getPort());
 
             auto client = getPeerImpl().getClient(node.getIp(), node.getPort());
-            auto cap = client->getMain<Peer>();
+            auto cap = PeerImpl::getPeer(*client, node);
             auto req = cap.sendPoWPuzzleResponseToBootstrapAndGetSuccessorRequest();
             PeerImpl::buildNode(req.getNewNode(), m_nodeInformation->getNode());
             req.setHashOfproofOfWorkPuzzleResponse(sFinalResponseToPuzzle);
@@ -494,6 +577,7 @@ void Dht::join(const NodeInformation::Node &node)
 
                     /* Sync data items from successor for which new node is responsible. */
                     getPeerImpl().getDataItemsOnJoinHelper(m_nodeInformation->getSuccessor());
+                    getPeerImpl().getMembersOnJoinHelper(successor);
                 } else {
                     this->m_nodeInformation->setSuccessor();
                 }
@@ -507,92 +591,360 @@ void Dht::join(const NodeInformation::Node &node)
     }).wait(client->getWaitScope());
 }
 
-void Dht::stabilize()
+kj::Promise<void> Dht::stabilize()
 {
     LOG_GET;
     auto successor = m_nodeInformation->getSuccessor();
     if (!successor) {
         LOG_TRACE("no successor");
-        return;
+        return kj::READY_NOW;
     }
 
     auto client = getPeerImpl().getClient(successor->getIp(), successor->getPort());
-    auto cap = client->getMain<Peer>();
+    auto cap = PeerImpl::getPeer(*client, *successor);
     auto req = cap.getPredecessorRequest();
+    if (m_membership) {
+        auto gossip = m_membership->gossip();
+        PeerImpl::buildMembers(req.initGossip(static_cast<unsigned>(gossip.size())), gossip);
+    }
 
-    /* Request pre(suc(cur)). */
-    auto predOfSuccessor = req.send().then([LOG_CAPTURE](capnp::Response<Peer::GetPredecessorResults> &&response) {
-        auto predOfSuccessor = PeerImpl::nodeFromReader(response.getNode());
-        if (!predOfSuccessor) {
-            LOG_TRACE("closest preceding empty response");
+    /* Request pre(suc(cur)), and the successor list of suc(cur). */
+    return withTimeout(*successor, req.send().attach(kj::mv(client))).then(
+        [LOG_CAPTURE, this](capnp::Response<Peer::GetPredecessorResults> &&response) {
+            PredecessorReply reply{.reachable= true, .predecessor= PeerImpl::nodeFromReader(response.getNode())};
+            if (!reply.predecessor) {
+                LOG_TRACE("closest preceding empty response");
+            }
+            for (auto node: response.getSuccessors())
+                reply.successors.push_back(PeerImpl::nodeFromReader(node));
+            if (m_membership)
+                m_membership->merge(PeerImpl::membersFromReader(response.getGossip()));
+            return reply;
+        }, [LOG_CAPTURE](const kj::Exception &e) {
+            LOG_DEBUG("connection issue with successor\n\t\t{}", e.getDescription().cStr());
+            return PredecessorReply{};
+        }
+    ).then([LOG_CAPTURE, this, successor](PredecessorReply &&reply) {
+        if (!reply.reachable) {
+            /* Fail over to the next entry of the successor list, without waiting for a lookup. */
+            m_nodeInformation->removePeer(*successor);
+            m_fingerScheduler.churn();
+            auto next = m_nodeInformation->getSuccessor();
+            if (next && *next != *successor) {
+                LOG_INFO("successor {}:{} failed, switching to {}:{}",
+                         successor->getIp(), successor->getPort(), next->getIp(), next->getPort());
+                return stabilize();
+            }
+            return kj::Promise<void>(kj::READY_NOW);
+        }
+
+        /* Our successor list is suc(cur), followed by the successor list of suc(cur). */
+        auto self = m_nodeInformation->getNode();
+        std::vector<NodeInformation::Node> successors{*successor};
+        for (const auto &node: reply.successors) {
+            if (successors.size() >= m_conf.successor_list_size || node == self)
+                break;
+            successors.push_back(node);
+        }
+
+        auto &predOfSuccessor = reply.predecessor;
+        /* If pred(suc(cur)) == cur, no need to do further processing. */
+        if (predOfSuccessor && *predOfSuccessor == self) {
+            m_nodeInformation->setSuccessorList(successors);
+            return kj::Promise<void>(kj::READY_NOW);
         }
-        return predOfSuccessor;
-    }, [LOG_CAPTURE](const kj::Exception &e) {
-        LOG_DEBUG("connection issue with successor\n\t\t{}", e.getDescription().cStr());
-        return std::optional<NodeInformation::Node>{};
-    }).wait(client->getWaitScope());
 
-    /* If pred(suc(cur)) == cur, no need to do further processing. */
-    if (!(predOfSuccessor && predOfSuccessor->getId() == m_nodeInformation->getId())) {
         /* if ( pred(suc(cur)) [called PSC] != null ) && if ( PSC is in range (cur, suc) )
          * then PSC is successor of cur and cur is predecessor of PSC. Update accordingly. */
         if (predOfSuccessor && util::is_in_range_loop(
-            predOfSuccessor->getId(), m_nodeInformation->getId(), successor->getId(),
+            predOfSuccessor->getKey(), self.getKey(), successor->getKey(),
             false, false
         )) {
+            successors.insert(successors.begin(), *predOfSuccessor);
+            if (successors.size() > m_conf.successor_list_size)
+                successors.pop_back();
             m_nodeInformation->setSuccessor(predOfSuccessor);
-            auto client2 = getPeerImpl().getClient(predOfSuccessor->getIp(), predOfSuccessor->getPort());
-            auto cap2 = client2->getMain<Peer>();
-            auto req2 = cap2.notifyRequest();
-            PeerImpl::buildNode(req2.getNode(), m_nodeInformation->getNode());
-            return req2.send().then([LOG_CAPTURE, this](capnp::Response<Peer::NotifyResults> &&) {
-                LOG_TRACE("got response from predecessor of successor");
-            }, [LOG_CAPTURE](const kj::Exception &e) {
-                LOG_DEBUG("connection issue with predecessor of successor\n\t\t{}", e.getDescription().cStr());
-            }).wait(client2->getWaitScope());
-        } else {
-            /* if ( pred(suc(cur)) [called PSC] == null  || ( PSC!=null && PSC not in range (cur, suc) ) )
-             * then cur is predecessor of suc(cur). */
-            auto client2 = getPeerImpl().getClient(successor->getIp(), successor->getPort());
-            auto cap2 = client2->getMain<Peer>();
-            auto req2 = cap2.notifyRequest();
-            PeerImpl::buildNode(req2.getNode(), m_nodeInformation->getNode());
-            return req2.send().then([LOG_CAPTURE, this](capnp::Response<Peer::NotifyResults> &&) {
-                LOG_TRACE("got response from successor");
-            }, [LOG_CAPTURE](const kj::Exception &e) {
-                LOG_DEBUG("connection issue with successor\n\t\t{}", e.getDescription().cStr());
-            }).wait(client2->getWaitScope());
+            m_nodeInformation->setSuccessorList(successors);
+            m_fingerScheduler.churn();
+            return notify(*predOfSuccessor);
         }
+        /* if ( pred(suc(cur)) [called PSC] == null  || ( PSC!=null && PSC not in range (cur, suc) ) )
+         * then cur is predecessor of suc(cur). */
+        m_nodeInformation->setSuccessorList(successors);
+        return notify(*successor);
+    });
+}
+
+kj::Promise<void> Dht::notify(const NodeInformation::Node &node)
+{
+    LOG_GET;
+    auto client = getPeerImpl().getClient(node.getIp(), node.getPort());
+    auto cap = PeerImpl::getPeer(*client, node);
+    auto req = cap.notifyRequest();
+    PeerImpl::buildNode(req.getNode(), m_nodeInformation->getNode());
+    if (m_membership) {
+        auto gossip = m_membership->gossip();
+        PeerImpl::buildMembers(req.initGossip(static_cast<unsigned>(gossip.size())), gossip);
     }
+    return withTimeout(node, req.send().attach(kj::mv(client)).ignoreResult()).then([LOG_CAPTURE]() {
+        LOG_TRACE("got response from new successor");
+    }, [LOG_CAPTURE](const kj::Exception &e) {
+        LOG_DEBUG("connection issue with new successor\n\t\t{}", e.getDescription().cStr());
+    });
 }
 
-void Dht::fixFingers()
+kj::Promise<void> Dht::fixFingers()
 {
     LOG_GET;
-    auto successor = getSuccessor(m_nodeInformation->getId() +
-                                  util::pow2<uint8_t, NodeInformation::key_bits / 8>(nextFinger));
-    m_nodeInformation->setFinger(
-        nextFinger,
-        successor);
-    nextFinger = (nextFinger + 1) % NodeInformation::key_bits;
+    auto routing = m_nodeInformation->getRouting();
+    if (!routing->successor)
+        return kj::READY_NOW;
+
+    auto index = m_fingerScheduler.next();
+    // Every hop of the lookup is bounded by its own deadline.
+    return getPeerImpl().getSuccessor((routing->self + util::uint256::pow2(index)).bytes()).catch_(
+        [LOG_CAPTURE](kj::Exception &&e) {
+            LOG_DEBUG("finger lookup failed\n\t\t{}", e.getDescription().cStr());
+            return std::optional<NodeInformation::Node>{};
+        }
+    ).then([LOG_CAPTURE, this, routing, index](std::optional<NodeInformation::Node> &&successor) -> kj::Promise<void> {
+        auto last = m_fingerScheduler.record(*routing, index, successor);
+        if (last == NodeInformation::key_bits - 1) {
+            auto stats = m_fingerScheduler.stats();
+            LOG_DEBUG("finger round done: {} lookups, {} changed, oldest finger: {}ms, next lookup in {}ms",
+                      stats.lookups_last_round, stats.changed_last_round,
+                      std::chrono::duration_cast<std::chrono::milliseconds>(stats.oldest).count(),
+                      stats.interval.count());
+        }
+
+        // Fingers before `last` have no node in their interval, they point to the successor of their start.
+        // Only the interval of `last` may hold more nodes to choose from. The successor itself is never replaced.
+        if (!successor || last == 0 || m_conf.pns_candidates < 2 ||
+            !FingerScheduler::isCandidate(routing->self, last, successor->getKey(), successor->getKey())) {
+            m_nodeInformation->setFingers(index, last, successor);
+            return kj::READY_NOW;
+        }
+        if (last > index)
+            m_nodeInformation->setFingers(index, last - 1, successor);
+        return closestCandidate(routing, last, *successor).then([this, last](NodeInformation::Node &&finger) {
+            m_nodeInformation->setFinger(last, finger);
+        });
+    });
 }
 
-void Dht::checkPredecessor()
+kj::Promise<void> Dht::fixDigitFingers()
 {
     LOG_GET;
-    if (!m_nodeInformation->getPredecessor())
-        return;
+    auto routing = m_nodeInformation->getRouting();
+    if (!routing->successor)
+        return kj::READY_NOW;
+
+    auto index = m_nextDigitFinger;
+    return getPeerImpl().getSuccessor((routing->self + m_digitOffsets[index]).bytes()).catch_(
+        [LOG_CAPTURE](kj::Exception &&e) {
+            LOG_DEBUG("digit finger lookup failed\n\t\t{}", e.getDescription().cStr());
+            return std::optional<NodeInformation::Node>{};
+        }
+    ).then([this, routing, index](std::optional<NodeInformation::Node> &&successor) {
+        // A failed lookup only answers its own finger.
+        auto last = successor
+                    ? FingerScheduler::lastDigitCovered(m_digitOffsets, index, successor->getKey() - routing->self)
+                    : index;
+        m_nodeInformation->setDigitFingers(index, last, successor);
+        m_nextDigitFinger = last + 1 < m_digitOffsets.size() ? last + 1 : 0;
+    });
+}
 
-    auto client = getPeerImpl().getClient(
-        m_nodeInformation->getPredecessor()->getIp(), m_nodeInformation->getPredecessor()->getPort()
+kj::Promise<NodeInformation::Node>
+Dht::closestCandidate(const NodeInformation::routing_snapshot &routing, size_t index,
+                      const NodeInformation::Node &successor)
+{
+    LOG_GET;
+    auto client = getPeerImpl().getClient(successor.getIp(), successor.getPort());
+    auto cap = PeerImpl::getPeer(*client, successor);
+    auto req = cap.getPredecessorRequest();
+    /* The successor list of the successor holds the next nodes, in order. */
+    return withTimeout(successor, req.send().attach(kj::mv(client))).then(
+        [LOG_CAPTURE, this, routing, index, successor](
+            capnp::Response<Peer::GetPredecessorResults> &&response) -> kj::Promise<NodeInformation::Node> {
+            auto inInterval = [&](const NodeInformation::Node &node) {
+                return node != successor &&
+                       FingerScheduler::isCandidate(routing->self, index, successor.getKey(), node.getKey());
+            };
+            std::vector<NodeInformation::Node> candidates{successor};
+            for (auto node: response.getSuccessors()) {
+                auto candidate = PeerImpl::nodeFromReader(node);
+                if (candidates.size() >= m_conf.pns_candidates || !inInterval(candidate))
+                    break;
+                candidates.push_back(candidate);
+            }
+            // Keeps the current finger in the running, so that it only changes for a closer node.
+            const auto &current = routing->fingers[index];
+            if (current && inInterval(*current) &&
+                std::find(candidates.begin(), candidates.end(), *current) == candidates.end())
+                candidates.push_back(*current);
+
+            /* Candidates that were never talked to are pinged, which measures their round trip time. */
+            kj::Vector<kj::Promise<void>> pings{};
+            for (const auto &candidate: candidates) {
+                if (m_failureDetector->rtt(candidate))
+                    continue;
+                auto client = getPeerImpl().getClient(candidate.getIp(), candidate.getPort());
+                auto cap = PeerImpl::getPeer(*client, candidate);
+                auto req = cap.getPredecessorRequest();
+                pings.add(withTimeout(candidate, req.send().attach(kj::mv(client)).ignoreResult()).catch_(
+                    [](kj::Exception &&) {}));
+            }
+            return kj::joinPromises(pings.releaseAsArray()).then([LOG_CAPTURE, this, candidates, successor]() {
+                auto best = successor;
+                auto bestRtt = m_failureDetector->rtt(successor);
+                for (const auto &candidate: candidates) {
+                    auto rtt = m_failureDetector->rtt(candidate);
+                    auto verdict = m_failureDetector->verdict(candidate);
+                    if (!rtt || verdict == FailureDetector::Verdict::SUSPECT ||
+                        verdict == FailureDetector::Verdict::DEAD)
+                        continue;
+                    if (!bestRtt || *rtt < *bestRtt) {
+                        best = candidate;
+                        bestRtt = rtt;
+                    }
+                }
+                if (best != successor) {
+                    LOG_TRACE("finger {}:{} is closer than the successor of its start, {}us",
+                              best.getIp(), best.getPort(), bestRtt->count());
+                }
+                return best;
+            });
+        }, [LOG_CAPTURE, successor](const kj::Exception &e) {
+            LOG_DEBUG("no candidates for the finger\n\t\t{}", e.getDescription().cStr());
+            return kj::Promise<NodeInformation::Node>(successor);
+        }
     );
-    auto cap = client->getMain<Peer>();
+}
+
+dht::FingerScheduler::Stats Dht::getFingerStats() const
+{
+    return m_fingerScheduler.stats();
+}
+
+std::vector<dht::FailureDetector::PeerStats> Dht::getPeerStats() const
+{
+    return m_failureDetector->stats();
+}
+
+dht::PeerImpl::VerificationStats Dht::getVerificationStats() const
+{
+    return m_peerImpl ? m_peerImpl->get().getVerificationStats() : PeerImpl::VerificationStats{};
+}
+
+dht::LookupCache::Stats Dht::getLookupCacheStats() const
+{
+    return m_lookupCache.stats();
+}
+
+std::vector<dht::Membership::Member> Dht::getMembers() const
+{
+    return m_membership ? m_membership->members() : std::vector<Membership::Member>{};
+}
+
+std::vector<std::shared_ptr<NodeInformation>> Dht::getVnodes() const
+{
+    std::vector<std::shared_ptr<NodeInformation>> vnodes{};
+    for (const auto &vnode: m_vnodes)
+        vnodes.push_back(vnode->m_nodeInformation);
+    return vnodes;
+}
+
+dht::ValueCache::Stats Dht::getValueCacheStats() const
+{
+    return m_valueCache.stats();
+}
+
+kj::Promise<void> Dht::checkPredecessor()
+{
+    LOG_GET;
+    auto predecessor = m_nodeInformation->getPredecessor();
+    if (!predecessor)
+        return kj::READY_NOW;
+    // The predecessor notifies us on every stabilize, that is as good as a ping.
+    if (m_failureDetector->verdict(*predecessor) == FailureDetector::Verdict::ALIVE)
+        return kj::READY_NOW;
+
+    auto client = getPeerImpl().getClient(predecessor->getIp(), predecessor->getPort());
+    auto cap = PeerImpl::getPeer(*client, *predecessor);
     auto req = cap.getPredecessorRequest(); // This request doesn't matter, it is used as a ping
-    return req.send().then([LOG_CAPTURE](capnp::Response<Peer::GetPredecessorResults> &&) {
+    return withTimeout(*predecessor, req.send().attach(kj::mv(client)).ignoreResult()).then([LOG_CAPTURE]() {
         LOG_TRACE("got response from predecessor");
     }, [LOG_CAPTURE, this](const kj::Exception &e) {
         LOG_ERR(e);
         // Delete predecessor
         m_nodeInformation->setPredecessor();
-    }).wait(client->getWaitScope());
+        m_fingerScheduler.churn();
+    });
+}
+
+kj::Promise<void> Dht::rebalance()
+{
+    LOG_GET;
+    auto predecessor = m_nodeInformation->getPredecessor();
+    // Only vnodes other than 0 can move, see PeerImpl::takeOver.
+    if (!predecessor || predecessor->getVnode() == 0 || *predecessor == m_nodeInformation->getNode())
+        return kj::READY_NOW;
+    auto load = getPeerImpl().load();
+    if (load == 0)
+        return kj::READY_NOW;
+
+    auto client = getPeerImpl().getClient(predecessor->getIp(), predecessor->getPort());
+    auto cap = PeerImpl::getPeer(*client, *predecessor);
+    auto req = cap.getLoadRequest();
+    return withTimeout(*predecessor, req.send().attach(kj::mv(client))).then(
+        [LOG_CAPTURE, this, predecessor = *predecessor, load](
+            capnp::Response<Peer::GetLoadResults> &&response) -> kj::Promise<void> {
+            auto predecessorLoad = response.getLoad();
+            if (!m_loadBalancer.overloaded(load, predecessorLoad))
+                return kj::READY_NOW;
+            auto split = m_loadBalancer.split(predecessor.getKey(), m_nodeInformation->getStoredItems(), load,
+                                              predecessorLoad);
+            if (!split)
+                return kj::READY_NOW;
+            LOG_DEBUG("load {} against {} of the predecessor, asking it to take over", load, predecessorLoad);
+
+            auto client = getPeerImpl().getClient(predecessor.getIp(), predecessor.getPort());
+            auto cap = PeerImpl::getPeer(*client, predecessor);
+            auto req = cap.takeOverRequest();
+            PeerImpl::buildNode(req.getNode(), m_nodeInformation->getNode());
+            req.setSplit(PeerImpl::containerToArray<kj::byte>(split->bytes()));
+            // The predecessor takes the items over before it answers, that may take as long as a lookup.
+            auto deadline = PeerImpl::clock_type::now() + std::chrono::milliseconds(m_conf.lookup_timeout);
+            return getPeerImpl().withDeadline(m_timer.value().get(), predecessor, req.send().attach(kj::mv(client)),
+                                              deadline).then(
+                [LOG_CAPTURE, this, predecessor](capnp::Response<Peer::TakeOverResults> &&response) {
+                    auto moved = PeerImpl::nodeFromReader(response.getNode());
+                    if (!moved) {
+                        LOG_DEBUG("predecessor declined");
+                        return;
+                    }
+                    // The old position is gone, there is no need to wait for the predecessor to notify.
+                    if (m_nodeInformation->getPredecessor() == predecessor) {
+                        dropMovedItems(*moved);
+                        m_nodeInformation->setPredecessor(moved);
+                    }
+                    m_fingerScheduler.churn();
+                });
+        });
+}
+
+void Dht::dropMovedItems(const NodeInformation::Node &moved)
+{
+    auto self = m_nodeInformation->getNode();
+    // Vnodes of one process share the data store, the items are in place already.
+    if (moved.getIp() == self.getIp() && moved.getPort() == self.getPort())
+        return;
+    auto items = m_nodeInformation->getDataItemsForNodeId(moved);
+    if (!items)
+        return;
+    std::vector<std::vector<uint8_t>> keys{};
+    for (const auto &item: *items)
+        keys.push_back(item.first);
+    m_nodeInformation->deleteDataAssignedToPredecessor(keys);
 }
@@ -12,8 +12,20 @@
 #include <peer.capnp.h>
 #include <exception>
 #include <stdexcept>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <type_traits>
+#include <kj/timer.h>
+#include <kj/vector.h>
 #include "Peer.h"
 #include "NodeInformation.h"
+#include "FingerScheduler.h"
+#include "FailureDetector.h"
+#include "LookupCache.h"
+#include "ValueCache.h"
+#include "Membership.h"
+#include "LoadBalancer.h"
 
 namespace dht
 {
@@ -21,14 +33,26 @@ namespace dht
     {
     public:
         explicit Dht(std::shared_ptr<NodeInformation> nodeInformation, config::Configuration conf) :
-            m_nodeInformation(std::move(nodeInformation)),
-            m_mainLoop(std::async(std::launch::async, [this]() { runServer(); })),
-            m_conf(std::move(conf)) {}
+            Dht(std::move(nodeInformation), std::move(conf), Vnode{})
+        {
+            // Vnodes join the ring through this node.
+            for (uint64_t index = 1; index < m_conf.vnodes; ++index) {
+                auto vnode = std::make_shared<NodeInformation>(*m_nodeInformation, static_cast<uint16_t>(index));
+                vnode->setBootstrapNode(m_nodeInformation->getNode());
+                m_vnodes.push_back(std::unique_ptr<Dht>(new Dht(std::move(vnode), m_conf, Vnode{})));
+            }
+            // Started last, the server's threads use the members above.
+            m_mainLoop = std::async(std::launch::async, [this]() { runServer(); });
+        }
         ~Dht()
         {
             m_dhtCancelled = true;
+            for (auto &vnode: m_vnodes)
+                vnode->m_dhtCancelled = true;
             m_api = nullptr;
-            m_mainLoop.wait(); // This happens after the destructor anyway, but this way it is clearer
+            // Vnodes have no thread of their own, they run on the server of their host.
+            if (m_mainLoop.valid())
+                m_mainLoop.wait(); // This happens after the destructor anyway, but this way it is clearer
 
             if (m_replicationFuture.valid()) {
                 m_replicationFuture.wait();
@@ -43,11 +67,67 @@ namespace dht
          */
         void setApi(std::unique_ptr<api::Api> api);
 
+        [[nodiscard]] FingerScheduler::Stats getFingerStats() const;
+        [[nodiscard]] std::vector<FailureDetector::PeerStats> getPeerStats() const;
+        /**
+         * @return Counters of the successor verifications of lookups, zero while the server is not running
+         */
+        [[nodiscard]] PeerImpl::VerificationStats getVerificationStats() const;
+        [[nodiscard]] LookupCache::Stats getLookupCacheStats() const;
+        [[nodiscard]] ValueCache::Stats getValueCacheStats() const;
+        /**
+         * @return Every member this node knows of, empty without full_membership
+         */
+        [[nodiscard]] std::vector<Membership::Member> getMembers() const;
+
+        /**
+         * @return The vnodes this process runs besides this node, empty unless vnodes is above 1
+         */
+        [[nodiscard]] std::vector<std::shared_ptr<NodeInformation>> getVnodes() const;
+
     private:
+        struct Vnode {};
+
+        /**
+         * @brief Sets up a node without running it. A vnode is run by the server of its host.
+         */
+        Dht(std::shared_ptr<NodeInformation> nodeInformation, config::Configuration conf, Vnode) :
+            m_nodeInformation(std::move(nodeInformation)),
+            m_conf(std::move(conf)),
+            m_fingerScheduler({
+                .min_interval= std::chrono::milliseconds(m_conf.fix_fingers_min_interval),
+                .max_interval= std::chrono::milliseconds(m_conf.fix_fingers_max_interval)
+            }),
+            m_digitOffsets(FingerScheduler::digitOffsets(m_conf.finger_base)),
+            m_failureDetector(std::make_shared<FailureDetector>(FailureDetector::Options{
+                .alive_for= std::chrono::milliseconds(m_conf.peer_alive_for),
+                .dead_after= m_conf.peer_dead_after
+            })),
+            m_loadBalancer({.ratio= m_conf.rebalance_ratio, .max_bytes= m_conf.rebalance_max_bytes}),
+            m_lookupCache(m_conf.lookup_cache_size),
+            m_valueCache({
+                .capacity= m_conf.value_cache_size,
+                .max_staleness= std::chrono::milliseconds(m_conf.value_cache_max_staleness)
+            }),
+            m_membership(m_conf.full_membership ? std::make_shared<Membership>(
+                m_nodeInformation->getNode(),
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count()),
+                Membership::Options{.gossip_size= m_conf.gossip_size}) : nullptr)
+        {}
+
         void runServer();
+        /**
+         * @brief Creates the PeerImpl of this node, which the server of the process owns.
+         */
+        kj::Own<PeerImpl> makePeerImpl();
+        /**
+         * @brief Adds the maintenance tasks of this node, which run on the server's event loop.
+         */
+        void scheduleMaintenance(kj::Vector<kj::Promise<void>> &maintenance);
 
         /**
-         * This is where the actual work happens.
+         * Joins or creates the ring whenever this node has no successor.
          * mainLoop is called asynchronously from the constructor of Dht.
          * It needs to worry about stopping itself.
          */
@@ -55,17 +135,82 @@ namespace dht
 
         void create();
         void join(const NodeInformation::Node &node);
-        void stabilize();
-        void fixFingers();
-        void checkPredecessor();
+
+        /**
+         * @brief
+         * Runs task on the server's event loop every interval(), jittered by +-25% so that nodes started together
+         * do not maintain in lockstep. Runs are independent of the other tasks, a slow peer only delays its own task.
+         */
+        kj::Promise<void> schedule(const char *name, std::function<std::chrono::milliseconds()> interval,
+                                   std::function<kj::Promise<void>()> task);
+        /**
+         * @brief Fails with a kj::Exception if the RPC to peer does not resolve within the RPC timeout.
+         */
+        template<typename T>
+        kj::Promise<T> withTimeout(const NodeInformation::Node &peer, kj::Promise<T> promise)
+        {
+            return getPeerImpl().withDeadline(m_timer.value().get(), peer, kj::mv(promise),
+                                              getPeerImpl().rpcDeadline());
+        }
+
+        kj::Promise<void> stabilize();
+        kj::Promise<void> notify(const NodeInformation::Node &node);
+        kj::Promise<void> fixFingers();
+        /**
+         * @brief
+         * Looks up the next digit finger. Like fixFingers, one lookup answers every following digit finger up to the
+         * node it returned.
+         */
+        kj::Promise<void> fixDigitFingers();
+        /**
+         * @brief
+         * Proximity neighbor selection: of the first pns_candidates nodes in the interval of finger index, starting
+         * with successor, returns the one with the lowest round trip time.
+         */
+        kj::Promise<NodeInformation::Node> closestCandidate(const NodeInformation::routing_snapshot &routing,
+                                                            size_t index, const NodeInformation::Node &successor);
+        kj::Promise<void> checkPredecessor();
+        /**
+         * @brief
+         * Compares the load of this node with its predecessor's. If this node is overloaded, asks the predecessor to
+         * take over the part of the arc that evens the loads out.
+         */
+        kj::Promise<void> rebalance();
+        /**
+         * @brief
+         * Deletes the items the predecessor took over when it moved forward to moved. Call before the predecessor is
+         * set to moved.
+         */
+        void dropMovedItems(const NodeInformation::Node &moved);
 
 
         [[nodiscard]] std::optional<NodeInformation::Node> getSuccessor(NodeInformation::id_type key);
-        std::vector<uint8_t> onDhtPut(const api::Message_DHT_PUT &m, std::atomic_bool &cancelled);
-        std::vector<uint8_t> onDhtGet(const api::Message_KEY &m, std::atomic_bool &cancelled);
-        std::vector<uint8_t> onDhtPutKeyIsHashOfData(const api::Message_DHT_PUT_KEY_IS_HASH_OF_DATA &message_data,
-                                                          std::atomic_bool &cancelled);
-        std::vector<uint8_t> onDhtGetKeyIsHashOfData(const api::Message_DHT_GET_KEY_IS_HASH_OF_DATA &message_data,
+        /**
+         * @brief
+         * Runs operation on the node responsible for key, taken from the lookup cache if possible. If the cached node
+         * gives no result, its entry is invalidated and operation runs again on the node a lookup returns.
+         * @return The node operation ran on last, empty if the lookup failed, and its result
+         */
+        template<typename Operation>
+        auto onResponsible(const NodeInformation::id_type &key, Operation operation)
+            -> std::pair<std::optional<NodeInformation::Node>, std::invoke_result_t<Operation, const NodeInformation::Node &>>
+        {
+            if (auto cached = m_lookupCache.find(key)) {
+                if (auto result = operation(*cached))
+                    return {cached, std::move(result)};
+                m_lookupCache.invalidate(*cached);
+            }
+            auto successor = getSuccessor(key);
+            if (!successor)
+                return {};
+            m_lookupCache.insert(key, *successor);
+            return {successor, operation(*successor)};
+        }
+        api::Response onDhtPut(const api::Message_DHT_PUT &m, std::atomic_bool &cancelled);
+        api::Response onDhtGet(const api::Message_KEY &m, std::atomic_bool &cancelled);
+        api::Response onDhtPutKeyIsHashOfData(const api::Message_DHT_PUT_KEY_IS_HASH_OF_DATA &message_data,
+                                              std::atomic_bool &cancelled);
+        api::Response onDhtGetKeyIsHashOfData(const api::Message_DHT_GET_KEY_IS_HASH_OF_DATA &message_data,
                                                      std::atomic_bool &cancelled);
 
         std::shared_ptr<NodeInformation> m_nodeInformation;
@@ -76,8 +221,26 @@ namespace dht
         std::atomic_bool m_mainLoopExited{false};
         std::optional<std::reference_wrapper<PeerImpl>> m_peerImpl;
         std::optional<std::reference_wrapper<const kj::Executor>> m_executor;
-        std::atomic<size_t> nextFinger{0};
+        std::optional<std::reference_wrapper<kj::Timer>> m_timer;
+        /// Only used on the server's thread.
+        std::mt19937 m_random{std::random_device{}()};
         const config::Configuration m_conf;
+        FingerScheduler m_fingerScheduler;
+        /// Starts of the digit fingers, relative to this node. Empty for finger_base 2.
+        const std::vector<util::uint256> m_digitOffsets;
+        /// Only used on the server's thread.
+        size_t m_nextDigitFinger{0};
+        /// Shared with the PeerImpl, which feeds it.
+        std::shared_ptr<FailureDetector> m_failureDetector;
+        LoadBalancer m_loadBalancer;
+        /// Responsible nodes of the keys of recent DHT operations.
+        LookupCache m_lookupCache;
+        /// Values of keys recently read through this node.
+        ValueCache m_valueCache;
+        /// Shared with the PeerImpl, nullptr without full_membership.
+        std::shared_ptr<Membership> m_membership;
+        /// Further ring positions of this process. They share its server, event loop and data store.
+        std::vector<std::unique_ptr<Dht>> m_vnodes{};
 
         // Getters
 
@@ -0,0 +1,108 @@
+#include "FailureDetector.h"
+#include <algorithm>
+
+using dht::FailureDetector;
+
+FailureDetector::FailureDetector(Options options) :
+    m_options(options)
+{
+}
+
+void FailureDetector::success(const NodeInformation::Node &peer, clock_type::duration rtt)
+{
+    std::scoped_lock lock(m_mutex);
+    auto now = clock_type::now();
+    auto &entry = m_peers[peer];
+    auto sample = std::chrono::duration_cast<std::chrono::microseconds>(rtt);
+    // Smoothed like TCP's SRTT, one sample moves the estimate by 1/8.
+    entry.srtt = entry.srtt ? *entry.srtt + (sample - *entry.srtt) / 8 : sample;
+    entry.last = now;
+    entry.lastAnswer = now;
+    entry.failures = 0;
+    prune(now);
+}
+
+void FailureDetector::heard(const NodeInformation::Node &peer)
+{
+    std::scoped_lock lock(m_mutex);
+    auto now = clock_type::now();
+    auto &entry = m_peers[peer];
+    entry.last = now;
+    entry.lastAnswer = now;
+    entry.failures = 0;
+    prune(now);
+}
+
+bool FailureDetector::failure(const NodeInformation::Node &peer)
+{
+    std::scoped_lock lock(m_mutex);
+    auto now = clock_type::now();
+    auto &entry = m_peers[peer];
+    entry.last = now;
+    ++entry.failures;
+    prune(now);
+    return entry.failures == m_options.dead_after;
+}
+
+FailureDetector::Verdict FailureDetector::verdict(const NodeInformation::Node &peer) const
+{
+    std::scoped_lock lock(m_mutex);
+    auto it = m_peers.find(peer);
+    return it == m_peers.end() ? Verdict::UNKNOWN : verdict(it->second, clock_type::now());
+}
+
+std::optional<std::chrono::microseconds> FailureDetector::rtt(const NodeInformation::Node &peer) const
+{
+    std::scoped_lock lock(m_mutex);
+    auto it = m_peers.find(peer);
+    return it == m_peers.end() ? std::optional<std::chrono::microseconds>{} : it->second.srtt;
+}
+
+std::vector<FailureDetector::PeerStats> FailureDetector::stats() const
+{
+    std::vector<PeerStats> stats{};
+    {
+        std::scoped_lock lock(m_mutex);
+        auto now = clock_type::now();
+        for (const auto &[peer, entry]: m_peers)
+            stats.push_back({peer, verdict(entry, now), entry.srtt, entry.failures, now - entry.last});
+    }
+    std::sort(stats.begin(), stats.end(), [](const auto &a, const auto &b) {
+        return a.verdict != b.verdict ? a.verdict > b.verdict : a.since < b.since;
+    });
+    return stats;
+}
+
+const char *FailureDetector::to_string(Verdict verdict)
+{
+    switch (verdict) {
+        case Verdict::ALIVE:
+            return "alive";
+        case Verdict::SUSPECT:
+            return "suspect";
+        case Verdict::DEAD:
+            return "dead";
+        default:
+            return "unknown";
+    }
+}
+
+FailureDetector::Verdict FailureDetector::verdict(const Entry &entry, clock_type::time_point now) const
+{
+    if (entry.failures >= m_options.dead_after)
+        return Verdict::DEAD;
+    if (entry.failures > 0)
+        return Verdict::SUSPECT;
+    if (entry.lastAnswer && now - *entry.lastAnswer < m_options.alive_for)
+        return Verdict::ALIVE;
+    return Verdict::UNKNOWN;
+}
+
+void FailureDetector::prune(clock_type::time_point now)
+{
+    if (m_peers.size() < m_pruneAt)
+        return;
+    // Peers of the routing table are contacted every few seconds, everything else may be forgotten.
+    std::erase_if(m_peers, [&](const auto &item) { return now - item.second.last > 60 * m_options.alive_for; });
+    m_pruneAt = std::max<size_t>(1024, 2 * m_peers.size());
+}
@@ -0,0 +1,111 @@
+#ifndef DHT_FAILUREDETECTOR_H
+#define DHT_FAILUREDETECTOR_H
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "NodeInformation.h"
+
+namespace dht
+{
+    /**
+     * @brief
+     * Liveness of peers, learned from the RPC traffic that is sent anyway.
+     *
+     * Every answered RPC refreshes a peer and feeds its round trip time, every failed or timed out RPC raises its
+     * suspicion. A peer that answered within the last `alive_for` is alive without asking it again. A failed RPC
+     * makes a peer suspect, `dead_after` failures in a row without an answer in between make it dead.
+     *
+     * Thread-safe.
+     */
+    class FailureDetector
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        struct Options
+        {
+            std::chrono::milliseconds alive_for{1000};
+            size_t dead_after{3};
+        };
+
+        enum class Verdict
+        {
+            /// Nothing recent is known, ask the peer.
+            UNKNOWN,
+            /// Answered within alive_for.
+            ALIVE,
+            /// The last RPC failed.
+            SUSPECT,
+            /// The last dead_after RPCs failed.
+            DEAD
+        };
+
+        struct PeerStats
+        {
+            NodeInformation::Node peer;
+            Verdict verdict;
+            /// Smoothed round trip time, empty if the peer never answered.
+            std::optional<std::chrono::microseconds> rtt;
+            /// Failed RPCs since the last answer.
+            size_t failures;
+            /// Time since the last answer or failure.
+            clock_type::duration since;
+        };
+
+        explicit FailureDetector(Options options);
+
+        /**
+         * @brief Records an answer of peer that took rtt.
+         */
+        void success(const NodeInformation::Node &peer, clock_type::duration rtt);
+        /**
+         * @brief Records a sign of life of peer without a round trip time, e.g. a request it sent.
+         */
+        void heard(const NodeInformation::Node &peer);
+        /**
+         * @brief Records a failed RPC to peer.
+         * @return true if this failure made peer dead
+         */
+        bool failure(const NodeInformation::Node &peer);
+
+        [[nodiscard]] Verdict verdict(const NodeInformation::Node &peer) const;
+        /**
+         * @return Smoothed round trip time of peer, empty if it never answered
+         */
+        [[nodiscard]] std::optional<std::chrono::microseconds> rtt(const NodeInformation::Node &peer) const;
+
+        /**
+         * @return All known peers, dead ones first
+         */
+        [[nodiscard]] std::vector<PeerStats> stats() const;
+
+        static const char *to_string(Verdict verdict);
+
+    private:
+        struct Entry
+        {
+            clock_type::time_point last{};
+            std::optional<clock_type::time_point> lastAnswer{};
+            std::optional<std::chrono::microseconds> srtt{};
+            size_t failures{0};
+        };
+
+        [[nodiscard]] Verdict verdict(const Entry &entry, clock_type::time_point now) const;
+        /**
+         * @brief Forgets peers that were not seen for a long time, once the table grew.
+         */
+        void prune(clock_type::time_point now);
+
+        const Options m_options;
+
+        mutable std::mutex m_mutex{};
+        std::unordered_map<NodeInformation::Node, Entry, NodeInformation::Node::Node_hash> m_peers{};
+        size_t m_pruneAt{1024};
+    };
+}
+
+#endif //DHT_FAILUREDETECTOR_H
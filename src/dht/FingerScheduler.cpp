@@ -0,0 +1,136 @@
+#include "FingerScheduler.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using dht::FingerScheduler;
+
+FingerScheduler::FingerScheduler(Options options) :
+    m_options(options),
+    m_interval(options.min_interval)
+{
+    m_refreshed.fill(clock_type::now());
+}
+
+size_t FingerScheduler::next() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_next;
+}
+
+size_t FingerScheduler::record(const NodeInformation::RoutingTable &routing, size_t index,
+                               const std::optional<NodeInformation::Node> &result)
+{
+    std::scoped_lock lock(m_mutex);
+    auto now = clock_type::now();
+    auto last = index;
+    if (result) {
+        last = lastCovered(index, result->getKey() - routing.self);
+        for (auto i = index; i <= last; ++i) {
+            const auto &finger = routing.fingers[i];
+            // A finger chosen by proximity from the interval of the last finger is as good as the result.
+            bool chosen = finger && i == last && isCandidate(routing.self, i, result->getKey(), finger->getKey());
+            if (!finger || (*finger != *result && !chosen))
+                ++m_changed;
+            m_refreshed[i] = now;
+        }
+    } else {
+        // A failed lookup is no sign of a stable ring.
+        ++m_changed;
+    }
+    ++m_lookups;
+
+    m_next = last + 1;
+    if (m_next >= NodeInformation::key_bits) {
+        ++m_lastRound.rounds;
+        m_lastRound.lookups_last_round = m_lookups;
+        m_lastRound.changed_last_round = m_changed;
+        m_interval = m_changed > 0 || m_churn
+                     ? m_options.min_interval
+                     : std::min(2 * m_interval, m_options.max_interval);
+        m_next = 0;
+        m_lookups = 0;
+        m_changed = 0;
+        m_churn = false;
+    }
+    return last;
+}
+
+void FingerScheduler::churn()
+{
+    std::scoped_lock lock(m_mutex);
+    m_churn = true;
+    m_interval = m_options.min_interval;
+}
+
+std::chrono::milliseconds FingerScheduler::interval() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_interval;
+}
+
+FingerScheduler::Stats FingerScheduler::stats() const
+{
+    std::scoped_lock lock(m_mutex);
+    auto now = clock_type::now();
+    auto stats = m_lastRound;
+    clock_type::duration total{};
+    for (const auto &refreshed: m_refreshed) {
+        stats.oldest = std::max(stats.oldest, now - refreshed);
+        total += now - refreshed;
+    }
+    stats.mean = total / static_cast<clock_type::rep>(m_refreshed.size());
+    stats.interval = m_interval;
+    return stats;
+}
+
+bool FingerScheduler::isCandidate(const util::uint256 &self, size_t index, const util::uint256 &successor,
+                                  const util::uint256 &node)
+{
+    auto start = self + util::uint256::pow2(index);
+    auto end = index + 1 < NodeInformation::key_bits ? self + util::uint256::pow2(index + 1) : self;
+    return util::is_in_range_loop(successor, start, end, true, false) &&
+           util::is_in_range_loop(node, successor, end, true, false);
+}
+
+size_t FingerScheduler::lastCovered(size_t index, const util::uint256 &distance)
+{
+    // The start of finger i is 2^i away from self, so it is covered iff 2^i <= distance.
+    if (distance.is_zero())
+        return NodeInformation::key_bits - 1;
+    return std::max(index, distance.bit_width() - 1);
+}
+
+std::vector<util::uint256> FingerScheduler::digitOffsets(size_t base)
+{
+    if (base < 2 || !std::has_single_bit(base))
+        throw std::invalid_argument("finger base must be a power of two");
+
+    auto digitBits = static_cast<size_t>(std::bit_width(base) - 1);
+    std::vector<util::uint256> offsets{};
+    for (size_t shift = 0; shift < NodeInformation::key_bits; shift += digitBits) {
+        for (size_t digit = 3; digit < base; ++digit) {
+            if (std::has_single_bit(digit))
+                continue;
+            // digit * base^level, as the sum of the bits of digit. Digits that overflow the ring are left out.
+            if (shift + static_cast<size_t>(std::bit_width(digit)) > NodeInformation::key_bits)
+                break;
+            util::uint256 offset{};
+            for (size_t bit = 0; (digit >> bit) != 0; ++bit) {
+                if ((digit >> bit) & 1)
+                    offset = offset + util::uint256::pow2(shift + bit);
+            }
+            offsets.push_back(offset);
+        }
+    }
+    return offsets;
+}
+
+size_t FingerScheduler::lastDigitCovered(const std::vector<util::uint256> &offsets, size_t index,
+                                         const util::uint256 &distance)
+{
+    if (distance.is_zero())
+        return offsets.size() - 1;
+    auto covered = static_cast<size_t>(std::upper_bound(offsets.begin(), offsets.end(), distance) - offsets.begin());
+    return covered == 0 ? index : std::max(index, covered - 1);
+}
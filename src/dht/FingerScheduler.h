@@ -0,0 +1,125 @@
+#ifndef DHT_FINGERSCHEDULER_H
+#define DHT_FINGERSCHEDULER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "NodeInformation.h"
+
+namespace dht
+{
+    /**
+     * @brief
+     * Decides which finger fixFingers looks up next, and how long to wait before the next lookup.
+     *
+     * Finger i starts at self + 2^i. A lookup that returns node n also answers every following finger whose start
+     * lies in (self, n], so one lookup per distinct finger interval refreshes the whole table. After a round that
+     * changed a finger, or after churn was reported, lookups run at the minimum interval; every unchanged round
+     * doubles the interval up to the maximum. A finger that was chosen by proximity from the nodes of its interval
+     * counts as unchanged.
+     *
+     * Thread-safe.
+     */
+    class FingerScheduler
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        struct Options
+        {
+            std::chrono::milliseconds min_interval{100};
+            std::chrono::milliseconds max_interval{4000};
+        };
+
+        struct Stats
+        {
+            /// Completed rounds over the whole table.
+            size_t rounds{0};
+            /// Lookups in the last completed round, i.e. the number of distinct finger intervals.
+            size_t lookups_last_round{0};
+            /// Fingers that changed in the last completed round.
+            size_t changed_last_round{0};
+            /// Time since the least recently refreshed finger was refreshed.
+            clock_type::duration oldest{};
+            /// Mean time since the fingers were refreshed.
+            clock_type::duration mean{};
+            std::chrono::milliseconds interval{};
+        };
+
+        explicit FingerScheduler(Options options);
+
+        /**
+         * @return Index of the finger to look up next
+         */
+        [[nodiscard]] size_t next() const;
+
+        /**
+         * @brief Records the lookup of finger `index` and advances to the next finger interval.
+         * @param routing Routing state the lookup started from
+         * @param result Successor of the finger's start, empty if the lookup failed
+         * @return Index of the last finger that result is the answer for. Fingers [index, last] should be set to it.
+         */
+        size_t record(const NodeInformation::RoutingTable &routing, size_t index,
+                      const std::optional<NodeInformation::Node> &result);
+
+        /**
+         * @brief Drops back to the minimum interval, e.g. after the successor or predecessor changed.
+         */
+        void churn();
+
+        /**
+         * @return Time to wait before the next lookup
+         */
+        [[nodiscard]] std::chrono::milliseconds interval() const;
+
+        [[nodiscard]] Stats stats() const;
+
+        /**
+         * @return Index of the last finger whose start lies in (self, self + distance], at least `index`.
+         * A distance of 0 stands for the whole ring.
+         */
+        static size_t lastCovered(size_t index, const util::uint256 &distance);
+
+        /**
+         * @return Whether node may be finger index instead of successor, the successor of the finger's start:
+         * both lie in the finger's interval [self + 2^index, self + 2^(index+1)), node not before successor.
+         * Proximity neighbor selection chooses among these nodes.
+         */
+        static bool isCandidate(const util::uint256 &self, size_t index, const util::uint256 &successor,
+                                const util::uint256 &node);
+
+        /**
+         * @brief
+         * A finger table of base b has b-1 fingers per level l, starting at self + j * b^l for the digits j in
+         * [1, b). The fingers whose digit is a power of two are the binary fingers, the others are digit fingers.
+         * @return Distances of the starts of the digit fingers from self, ascending. Empty for base 2.
+         * @throws std::invalid_argument if base is not a power of two
+         */
+        static std::vector<util::uint256> digitOffsets(size_t base);
+
+        /**
+         * @return Index of the last digit finger whose start lies in (self, self + distance], at least `index`.
+         * A distance of 0 stands for the whole ring.
+         */
+        static size_t lastDigitCovered(const std::vector<util::uint256> &offsets, size_t index,
+                                       const util::uint256 &distance);
+
+    private:
+        const Options m_options;
+
+        mutable std::mutex m_mutex{};
+        size_t m_next{0};
+        std::chrono::milliseconds m_interval;
+        std::array<clock_type::time_point, NodeInformation::key_bits> m_refreshed{};
+
+        size_t m_lookups{0};
+        size_t m_changed{0};
+        bool m_churn{false};
+        Stats m_lastRound{};
+    };
+}
+
+#endif //DHT_FINGERSCHEDULER_H
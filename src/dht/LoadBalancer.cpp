@@ -0,0 +1,88 @@
+#include "LoadBalancer.h"
+#include <algorithm>
+
+using dht::LoadBalancer;
+using dht::RequestRate;
+
+LoadBalancer::LoadBalancer(Options options) :
+    m_options(options)
+{
+}
+
+bool LoadBalancer::overloaded(uint64_t load, uint64_t predecessorLoad) const
+{
+    return load > 0 && load > m_options.ratio * predecessorLoad;
+}
+
+std::optional<util::uint256>
+LoadBalancer::split(const util::uint256 &predecessor, std::vector<NodeInformation::StoredItem> items, uint64_t load,
+                    uint64_t predecessorLoad) const
+{
+    if (items.empty() || load <= predecessorLoad)
+        return {};
+
+    std::sort(items.begin(), items.end(), [&predecessor](const auto &a, const auto &b) {
+        return a.id - predecessor < b.id - predecessor;
+    });
+    uint64_t total = 0;
+    for (const auto &item: items)
+        total += item.bytes;
+
+    // Half of the difference evens the loads out, in bytes if the load is measured in requests.
+    auto share = static_cast<double>(load - predecessorLoad) / (2.0 * static_cast<double>(load));
+    auto target = std::min(m_options.max_bytes, static_cast<uint64_t>(share * static_cast<double>(total)));
+
+    std::optional<util::uint256> split{};
+    uint64_t moved = 0;
+    for (const auto &item: items) {
+        moved += item.bytes;
+        if (moved > target)
+            break;
+        split = item.id;
+    }
+    return split;
+}
+
+std::optional<size_t>
+LoadBalancer::position(const util::uint256 &from, const util::uint256 &split,
+                       const std::vector<util::uint256> &candidates)
+{
+    std::optional<size_t> best{};
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!util::is_in_range_loop(candidates[i], from, split, false, true))
+            continue;
+        if (!best || candidates[i] - from > candidates[*best] - from)
+            best = i;
+    }
+    return best;
+}
+
+RequestRate::RequestRate(clock_type::duration window, clock_type::time_point now) :
+    m_window(window),
+    m_start(now)
+{
+}
+
+void RequestRate::add(clock_type::time_point now)
+{
+    std::scoped_lock lock(m_mutex);
+    roll(now);
+    ++m_current;
+}
+
+uint64_t RequestRate::rate(clock_type::time_point now)
+{
+    std::scoped_lock lock(m_mutex);
+    roll(now);
+    return m_previous;
+}
+
+void RequestRate::roll(clock_type::time_point now)
+{
+    if (now - m_start < m_window)
+        return;
+    // A window without requests in between leaves nothing to report.
+    m_previous = now - m_start < 2 * m_window ? m_current : 0;
+    m_current = 0;
+    m_start = now - (now - m_start) % m_window;
+}
@@ -0,0 +1,90 @@
+#ifndef DHT_LOADBALANCER_H
+#define DHT_LOADBALANCER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "NodeInformation.h"
+
+namespace dht
+{
+    /**
+     * @brief
+     * Decides when a node hands part of its arc to its predecessor, and up to which id.
+     *
+     * A node is overloaded once its load is more than ratio times the load of its predecessor. The predecessor then
+     * moves forward into the arc of the node, to a split id chosen so that both end up with about the same load, and
+     * takes over the items up to it. A move never carries more than max_bytes.
+     *
+     * Thread-safe.
+     */
+    class LoadBalancer
+    {
+    public:
+        struct Options
+        {
+            uint64_t ratio{2};
+            uint64_t max_bytes{1 << 20};
+        };
+
+        explicit LoadBalancer(Options options);
+
+        [[nodiscard]] bool overloaded(uint64_t load, uint64_t predecessorLoad) const;
+
+        /**
+         * @param predecessor Id of the predecessor, the arc of this node starts after it
+         * @param items Items this node is responsible for
+         * @return The last id the predecessor takes over, empty if not even the first item fits into one move
+         */
+        [[nodiscard]] std::optional<util::uint256>
+        split(const util::uint256 &predecessor, std::vector<NodeInformation::StoredItem> items, uint64_t load,
+              uint64_t predecessorLoad) const;
+
+        /**
+         * @return Index of the candidate in (from, split] that is furthest from from, i.e. the position that takes
+         * over the most of the arc without passing split. Empty if no candidate is in range.
+         */
+        [[nodiscard]] static std::optional<size_t>
+        position(const util::uint256 &from, const util::uint256 &split, const std::vector<util::uint256> &candidates);
+
+    private:
+        const Options m_options;
+    };
+
+    /**
+     * @brief
+     * Counts requests in windows of fixed length. The rate is the count of the last complete window, so it does not
+     * depend on when it is read.
+     *
+     * Thread-safe.
+     */
+    class RequestRate
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        explicit RequestRate(clock_type::duration window, clock_type::time_point now = clock_type::now());
+
+        void add(clock_type::time_point now = clock_type::now());
+
+        /**
+         * @return Requests in the last complete window
+         */
+        [[nodiscard]] uint64_t rate(clock_type::time_point now = clock_type::now());
+
+    private:
+        void roll(clock_type::time_point now);
+
+        const clock_type::duration m_window;
+
+        std::mutex m_mutex{};
+        clock_type::time_point m_start;
+        uint64_t m_current{0};
+        uint64_t m_previous{0};
+    };
+}
+
+#endif //DHT_LOADBALANCER_H
@@ -0,0 +1,83 @@
+#include "LookupCache.h"
+
+using dht::LookupCache;
+
+LookupCache::LookupCache(size_t capacity) :
+    m_capacity(capacity)
+{
+}
+
+std::optional<NodeInformation::Node> LookupCache::find(const NodeInformation::id_type &key)
+{
+    std::scoped_lock lock(m_mutex);
+    auto id = util::uint256(key);
+    // Ranges do not overlap, only the first node at or after id can be responsible for it.
+    auto it = m_entries.lower_bound(id);
+    if (it == m_entries.end())
+        it = m_entries.begin();
+    if (it == m_entries.end() || !util::is_in_range_loop(id, it->second.low, it->first, true, true)) {
+        ++m_stats.misses;
+        return {};
+    }
+    ++m_stats.hits;
+    m_used.splice(m_used.begin(), m_used, it->second.used);
+    return it->second.node;
+}
+
+void LookupCache::insert(const NodeInformation::id_type &key, const NodeInformation::Node &node)
+{
+    if (m_capacity == 0)
+        return;
+
+    std::scoped_lock lock(m_mutex);
+    auto id = util::uint256(key);
+    auto nodeId = node.getKey();
+
+    // Nodes between id and node would have been responsible for id, they are gone.
+    while (id != nodeId && !m_entries.empty()) {
+        auto it = m_entries.lower_bound(id);
+        if (it == m_entries.end())
+            it = m_entries.begin();
+        if (!util::is_in_range_loop(it->first, id, nodeId, true, false))
+            break;
+        erase(it);
+        ++m_stats.invalidations;
+    }
+
+    auto it = m_entries.find(nodeId);
+    if (it != m_entries.end()) {
+        if (nodeId - id > nodeId - it->second.low)
+            it->second.low = id;
+        m_used.splice(m_used.begin(), m_used, it->second.used);
+        return;
+    }
+
+    if (m_entries.size() >= m_capacity)
+        erase(m_entries.find(m_used.back()));
+    m_used.push_front(nodeId);
+    m_entries.emplace(nodeId, Entry{node, id, m_used.begin()});
+}
+
+void LookupCache::invalidate(const NodeInformation::Node &node)
+{
+    std::scoped_lock lock(m_mutex);
+    auto it = m_entries.find(node.getKey());
+    if (it == m_entries.end())
+        return;
+    erase(it);
+    ++m_stats.invalidations;
+}
+
+LookupCache::Stats LookupCache::stats() const
+{
+    std::scoped_lock lock(m_mutex);
+    auto stats = m_stats;
+    stats.size = m_entries.size();
+    return stats;
+}
+
+void LookupCache::erase(entries_type::iterator it)
+{
+    m_used.erase(it->second.used);
+    m_entries.erase(it);
+}
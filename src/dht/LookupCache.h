@@ -0,0 +1,83 @@
+#ifndef DHT_LOOKUPCACHE_H
+#define DHT_LOOKUPCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include "NodeInformation.h"
+
+namespace dht
+{
+    /**
+     * @brief
+     * Remembers which node was responsible for which ids, so that operations on keys that were resolved recently
+     * skip the lookup.
+     *
+     * A lookup of id k that returned node n shows that n is responsible for [k, n]. Lookups of other ids that
+     * returned n extend the range back. Entries are not checked when they are used: the caller invalidates an
+     * entry once the node does not have the data it should have, or does not answer, and looks the id up again.
+     * Least recently used entries are evicted first.
+     *
+     * Thread-safe.
+     */
+    class LookupCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t hits{0};
+            uint64_t misses{0};
+            uint64_t invalidations{0};
+            size_t size{0};
+        };
+
+        /**
+         * @param capacity Maximum number of nodes to remember, 0 disables the cache
+         */
+        explicit LookupCache(size_t capacity);
+
+        /**
+         * @return The node responsible for key, if a cached range contains it
+         */
+        std::optional<NodeInformation::Node> find(const NodeInformation::id_type &key);
+
+        /**
+         * @brief Records that a lookup of key returned node.
+         */
+        void insert(const NodeInformation::id_type &key, const NodeInformation::Node &node);
+
+        /**
+         * @brief Forgets the range of node.
+         */
+        void invalidate(const NodeInformation::Node &node);
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        struct Entry
+        {
+            NodeInformation::Node node;
+            /// First id of the range, the range ends at the node's id.
+            util::uint256 low;
+            std::list<util::uint256>::iterator used;
+        };
+
+        using entries_type = std::map<util::uint256, Entry>;
+
+        void erase(entries_type::iterator it);
+
+        const size_t m_capacity;
+
+        mutable std::mutex m_mutex{};
+        /// By the id of the node.
+        entries_type m_entries{};
+        /// Node ids, most recently used first.
+        std::list<util::uint256> m_used{};
+        Stats m_stats{};
+    };
+}
+
+#endif //DHT_LOOKUPCACHE_H
@@ -0,0 +1,144 @@
+#include "Membership.h"
+#include <algorithm>
+#include <bit>
+
+using dht::Membership;
+
+Membership::Membership(const NodeInformation::Node &self, uint64_t incarnation, Options options) :
+    m_self(self.getKey()),
+    m_options(options)
+{
+    m_entries.emplace(m_self, Entry{Member{self, true, incarnation}, clock_type::now(), 0});
+    m_alive = 1;
+}
+
+std::optional<NodeInformation::Node> Membership::successor(const NodeInformation::id_type &id) const
+{
+    std::scoped_lock lock(m_mutex);
+    auto it = m_entries.lower_bound(util::uint256(id));
+    for (size_t i = 0; i < m_entries.size(); ++i, ++it) {
+        if (it == m_entries.end())
+            it = m_entries.begin();
+        if (it->second.member.alive)
+            return it->second.member.node;
+    }
+    return {};
+}
+
+void Membership::merge(const std::vector<Member> &gossip)
+{
+    std::scoped_lock lock(m_mutex);
+    for (const auto &member: gossip)
+        apply(member);
+}
+
+void Membership::dead(const NodeInformation::Node &peer)
+{
+    std::scoped_lock lock(m_mutex);
+    auto it = m_entries.find(peer.getKey());
+    if (it != m_entries.end() && it->second.member.alive)
+        apply(Member{peer, false, it->second.member.incarnation});
+}
+
+std::vector<Membership::Member> Membership::gossip()
+{
+    std::scoped_lock lock(m_mutex);
+    prune();
+
+    std::vector<Member> gossip{m_entries.at(m_self).member};
+    std::vector<Entry *> recent{};
+    for (auto &[key, entry]: m_entries) {
+        if (key != m_self && entry.transmissions > 0)
+            recent.push_back(&entry);
+    }
+    // Changes that were sent the least often first.
+    auto count = std::min(recent.size(), m_options.gossip_size - 1);
+    std::partial_sort(recent.begin(), recent.begin() + static_cast<std::ptrdiff_t>(count), recent.end(),
+                      [](const Entry *a, const Entry *b) { return a->transmissions > b->transmissions; });
+    for (size_t i = 0; i < count; ++i) {
+        gossip.push_back(recent[i]->member);
+        --recent[i]->transmissions;
+    }
+
+    // The rest round robin, so that every member is sent now and then.
+    auto it = m_entries.upper_bound(m_cursor);
+    for (size_t i = 0; i < m_entries.size() && gossip.size() < m_options.gossip_size; ++i, ++it) {
+        if (it == m_entries.end())
+            it = m_entries.begin();
+        m_cursor = it->first;
+        auto included = [&](const Member &member) { return member.node == it->second.member.node; };
+        if (std::none_of(gossip.begin(), gossip.end(), included))
+            gossip.push_back(it->second.member);
+    }
+    return gossip;
+}
+
+std::vector<Membership::Member> Membership::members() const
+{
+    std::scoped_lock lock(m_mutex);
+    std::vector<Member> members{};
+    members.reserve(m_entries.size());
+    for (const auto &[key, entry]: m_entries)
+        members.push_back(entry.member);
+    return members;
+}
+
+size_t Membership::size() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_alive;
+}
+
+bool Membership::apply(const Member &member)
+{
+    auto key = member.node.getKey();
+    auto it = m_entries.find(key);
+    if (key == m_self) {
+        // Only this node changes its own entry, it refutes that it is dead.
+        auto &own = it->second.member;
+        if (member.alive || member.incarnation < own.incarnation)
+            return false;
+        own.incarnation = member.incarnation + 1;
+        changed(it->second);
+        return true;
+    }
+
+    if (it == m_entries.end()) {
+        // Dead members are kept too, older gossip must not bring them back.
+        it = m_entries.emplace(key, Entry{member, clock_type::now(), 0}).first;
+        if (member.alive)
+            ++m_alive;
+        changed(it->second);
+        return true;
+    }
+
+    auto &known = it->second.member;
+    bool newer = member.incarnation > known.incarnation ||
+                 (member.incarnation == known.incarnation && known.alive && !member.alive);
+    if (!newer)
+        return false;
+    if (known.alive != member.alive) {
+        if (member.alive)
+            ++m_alive;
+        else
+            --m_alive;
+    }
+    known = member;
+    changed(it->second);
+    return true;
+}
+
+void Membership::changed(Entry &entry)
+{
+    entry.changed = clock_type::now();
+    entry.transmissions = m_options.retransmit_factor * static_cast<size_t>(std::bit_width(m_alive));
+}
+
+void Membership::prune()
+{
+    auto now = clock_type::now();
+    std::erase_if(m_entries, [&](const auto &item) {
+        const auto &entry = item.second;
+        return !entry.member.alive && now - entry.changed > m_options.tombstone_for;
+    });
+}
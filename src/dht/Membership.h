@@ -0,0 +1,115 @@
+#ifndef DHT_MEMBERSHIP_H
+#define DHT_MEMBERSHIP_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "NodeInformation.h"
+
+namespace dht
+{
+    /**
+     * @brief
+     * Every node of the ring, so that the node responsible for an id is found without a lookup.
+     *
+     * Changes are spread by gossip piggybacked on the RPCs of stabilize and notify: every message carries the
+     * sender's own entry, the most recent changes and, round robin, entries of other members, so that members that
+     * missed a change catch up. A change is sent retransmit_factor * log2(N) times.
+     *
+     * Entries are versioned by the incarnation of their node, which only the node itself increases. An entry that
+     * says alive overrides older incarnations, one that says dead overrides its own incarnation and older ones.
+     * A node that hears it is dead refutes it with a new incarnation. Dead entries are kept for tombstone_for, so
+     * that older gossip does not bring them back.
+     *
+     * Thread-safe.
+     */
+    class Membership
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        struct Options
+        {
+            /// Entries per message, the sender's own entry included.
+            size_t gossip_size{16};
+            size_t retransmit_factor{3};
+            std::chrono::milliseconds tombstone_for{60000};
+        };
+
+        struct Member
+        {
+            NodeInformation::Node node;
+            bool alive{true};
+            uint64_t incarnation{0};
+        };
+
+        /**
+         * @param incarnation Incarnation of self, must grow when the node restarts, e.g. the start time
+         */
+        Membership(const NodeInformation::Node &self, uint64_t incarnation, Options options);
+
+        /**
+         * @return The first alive member at or after id, going clockwise
+         */
+        [[nodiscard]] std::optional<NodeInformation::Node> successor(const NodeInformation::id_type &id) const;
+
+        /**
+         * @brief Applies gossip received from a peer.
+         */
+        void merge(const std::vector<Member> &gossip);
+
+        /**
+         * @brief Marks peer dead, e.g. because the failure detector gave up on it.
+         */
+        void dead(const NodeInformation::Node &peer);
+
+        /**
+         * @return Entries to piggyback on the next message
+         */
+        std::vector<Member> gossip();
+
+        /**
+         * @return Every member, dead ones included, in ring order
+         */
+        [[nodiscard]] std::vector<Member> members() const;
+
+        /**
+         * @return Number of alive members, this node included
+         */
+        [[nodiscard]] size_t size() const;
+
+    private:
+        struct Entry
+        {
+            Member member;
+            /// When the entry last changed, tombstones are dropped tombstone_for after.
+            clock_type::time_point changed;
+            /// How many more messages carry the change.
+            size_t transmissions;
+        };
+
+        using entries_type = std::map<util::uint256, Entry>;
+
+        /**
+         * @return Whether member replaced the entry of its node
+         */
+        bool apply(const Member &member);
+        void changed(Entry &entry);
+        void prune();
+
+        const util::uint256 m_self;
+        const Options m_options;
+
+        mutable std::mutex m_mutex{};
+        entries_type m_entries{};
+        size_t m_alive{0};
+        /// Id after the last entry gossiped round robin.
+        util::uint256 m_cursor{};
+    };
+}
+
+#endif //DHT_MEMBERSHIP_H
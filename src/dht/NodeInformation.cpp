@@ -2,6 +2,7 @@
 #include <centralLogControl.h>
 #include <util.h>
 #include <spdlog/fmt/chrono.h>
+#include <unordered_map>
 
 using namespace std::chrono_literals;
 
@@ -12,14 +13,15 @@ uint8_t NodeInformation::m_replicationLimit = DEFAULT_REPLICATION_LIMIT;
 
 NodeInformation::NodeInformation(std::string host, uint16_t port) : m_node(std::move(host), port)
 {
+    updateRouting([](RoutingTable &) {});
     m_dataCleaner = std::async(std::launch::async, [this]() {
         while (!m_destroyed) {
             {
-                std::unique_lock l{m_dataMutex};
-                for (auto it = m_data.begin(); it != m_data.end();) {
+                std::unique_lock l{m_storage->mutex};
+                for (auto it = m_storage->data.begin(); it != m_storage->data.end();) {
                     auto tp = std::chrono::system_clock::now();
                     if (it->second.second < tp) {
-                        it = m_data.erase(it);
+                        it = m_storage->erase(it);
                     } else {
                         ++it;
                     }
@@ -31,86 +33,212 @@ NodeInformation::NodeInformation(std::string host, uint16_t port) : m_node(std::
     });
 }
 
+NodeInformation::NodeInformation(const NodeInformation &host, uint16_t vnode) :
+    m_node(host.getIp(), host.getPort(), vnode),
+    m_storage(host.m_storage)
+{
+    updateRouting([](RoutingTable &) {});
+}
+
 NodeInformation::~NodeInformation()
 {
     m_destroyed = true;
     m_cv.notify_all();
-    m_dataCleaner.wait();
+    if (m_dataCleaner.valid())
+        m_dataCleaner.wait();
 }
 
 // Getters and Setters
 NodeInformation::Node NodeInformation::getNode() const
 {
+    std::shared_lock l{m_nodeMutex};
     return m_node;
 }
 void NodeInformation::setNode(const Node &node)
 {
-    m_node = node;
+    updateNode([&node](Node &self) { self = node; });
 }
 std::string NodeInformation::getIp() const
 {
+    std::shared_lock l{m_nodeMutex};
     return m_node.getIp();
 }
 void NodeInformation::setIp(const std::string &mIp)
 {
-    m_node.setIp(mIp);
+    updateNode([&mIp](Node &self) { self.setIp(mIp); });
 }
 uint16_t NodeInformation::getPort() const
 {
+    std::shared_lock l{m_nodeMutex};
     return m_node.getPort();
 }
 void NodeInformation::setPort(uint16_t mPort)
 {
-    m_node.setPort(mPort);
+    updateNode([mPort](Node &self) { self.setPort(mPort); });
 }
 NodeInformation::id_type NodeInformation::getId() const
 {
+    std::shared_lock l{m_nodeMutex};
     return m_node.getId();
 }
 void NodeInformation::setId(std::optional<id_type> id)
 {
-    m_node.setId(id);
+    updateNode([&id](Node &self) { self.setId(id); });
 }
 std::optional<NodeInformation::Node> NodeInformation::getFinger(size_t index) const
 {
-    std::shared_lock l{m_fingerTableMutex};
-    if (index >= m_fingerTable.size())
+    if (index >= key_bits)
         throw std::out_of_range("index out of bounds");
-    return m_fingerTable[index];
+    auto routing = getRouting();
+    return routing->fingers[index] ? std::optional<Node>{*routing->fingers[index]} : std::optional<Node>{};
 }
 void NodeInformation::setFinger(size_t index, const std::optional<Node> &node)
 {
-    std::unique_lock l{m_fingerTableMutex};
-    if (index >= m_fingerTable.size())
+    if (index >= key_bits)
+        throw std::out_of_range("index out of bounds");
+    updateRouting([&](RoutingTable &routing) { routing.setFinger(index, node); });
+}
+void NodeInformation::setFingers(size_t first, size_t last, const std::optional<Node> &node)
+{
+    if (first > last || last >= key_bits)
         throw std::out_of_range("index out of bounds");
-    m_fingerTable[index] = node;
+    updateRouting([&](RoutingTable &routing) {
+        for (auto i = first; i <= last; ++i)
+            routing.setFinger(i, node);
+    });
+}
+void NodeInformation::setDigitFingers(size_t first, size_t last, const std::optional<Node> &node)
+{
+    if (first > last)
+        throw std::out_of_range("index out of bounds");
+    updateRouting([&](RoutingTable &routing) {
+        if (routing.digitFingers.size() <= last)
+            routing.digitFingers.resize(last + 1);
+        auto handle = node ? routing.intern(*node) : node_handle{};
+        std::fill(routing.digitFingers.begin() + static_cast<std::ptrdiff_t>(first),
+                  routing.digitFingers.begin() + static_cast<std::ptrdiff_t>(last) + 1, handle);
+    });
 }
-std::optional<NodeInformation::Node> NodeInformation::getSuccessor()
+NodeInformation::node_handle NodeInformation::getClosestPreceding(const id_type &id) const
 {
-    std::shared_lock f{m_fingerTableMutex};
-    for (auto &finger: m_fingerTable)
-        if (finger) return finger;
-    return m_fingerTable[0];
+    return getRouting()->closestPreceding(util::uint256(id));
+}
+NodeInformation::routing_snapshot NodeInformation::getRouting() const
+{
+#ifdef __cpp_lib_atomic_shared_ptr
+    return m_routing.load();
+#else
+    return std::atomic_load(&m_routing);
+#endif
+}
+std::optional<NodeInformation::Node> NodeInformation::getSuccessor() const
+{
+    auto successor = getSuccessorHandle();
+    return successor ? std::optional<Node>{*successor} : std::optional<Node>{};
+}
+NodeInformation::node_handle NodeInformation::getSuccessorHandle() const
+{
+    return getRouting()->successor;
 }
 void NodeInformation::setSuccessor(const std::optional<Node> &node)
 {
-    std::unique_lock f{m_fingerTableMutex};
-    m_fingerTable[0] = node;
+    setFinger(0, node);
 }
 std::optional<NodeInformation::Node> NodeInformation::getPredecessor() const
 {
-    std::shared_lock f{m_predecessorMutex};
-    return m_predecessor;
+    auto predecessor = getRouting()->predecessor;
+    return predecessor ? std::optional<Node>{*predecessor} : std::optional<Node>{};
 }
 void NodeInformation::setPredecessor(const std::optional<Node> &node)
 {
-    std::unique_lock f{m_predecessorMutex};
-    m_predecessor = node;
+    updateRouting([&](RoutingTable &routing) {
+        routing.predecessor = node ? routing.intern(*node) : node_handle{};
+    });
+}
+std::vector<NodeInformation::Node> NodeInformation::getSuccessorList() const
+{
+    std::vector<Node> ret{};
+    for (const auto &successor: getRouting()->successors)
+        ret.push_back(*successor);
+    return ret;
+}
+void NodeInformation::setSuccessorList(const std::vector<Node> &successors)
+{
+    updateRouting([&](RoutingTable &routing) {
+        routing.successors.clear();
+        for (const auto &successor: successors)
+            routing.successors.push_back(routing.intern(successor));
+    });
+}
+void NodeInformation::removePeer(const Node &node)
+{
+    updateRouting([&](RoutingTable &routing) {
+        auto failed = [&](const node_handle &handle) { return handle && *handle == node; };
+        bool wasSuccessor = failed(routing.fingers[0]);
+        for (size_t i = 0; i < key_bits; ++i) {
+            if (failed(routing.fingers[i]))
+                routing.setFinger(i, {});
+        }
+        std::erase_if(routing.successors, failed);
+        std::erase_if(routing.learned, failed);
+        for (auto &finger: routing.digitFingers) {
+            if (failed(finger))
+                finger.reset();
+        }
+        if (failed(routing.predecessor))
+            routing.predecessor.reset();
+        if (wasSuccessor && !routing.successors.empty()) {
+            routing.fingers[0] = routing.successors.front();
+            routing.fingerIds[0] = routing.fingers[0]->getKey();
+        }
+    });
+}
+void NodeInformation::learnNodes(const std::vector<Node> &nodes, size_t capacity)
+{
+    auto routing = getRouting();
+    auto unknown = [&](const Node &node) { return node.getKey() != routing->self && !routing->routesTo(node); };
+    if (capacity == 0 || std::none_of(nodes.begin(), nodes.end(), unknown))
+        return;
+
+    updateRouting([&](RoutingTable &routing) {
+        auto first = routing.learned.size();
+        for (const auto &node: nodes) {
+            auto added = [&](const node_handle &handle) { return *handle == node; };
+            if (node.getKey() != routing.self && !routing.routesTo(node) &&
+                std::none_of(routing.learned.begin() + static_cast<std::ptrdiff_t>(first), routing.learned.end(), added))
+                routing.learned.push_back(routing.intern(node));
+        }
+        if (routing.learned.size() > capacity)
+            routing.learned.erase(routing.learned.begin(),
+                                  routing.learned.end() - static_cast<std::ptrdiff_t>(capacity));
+    });
+}
+void NodeInformation::countTimeout(const Node &peer)
+{
+    std::scoped_lock l{m_timeoutsMutex};
+    ++m_timeouts[peer];
+}
+std::vector<std::pair<NodeInformation::Node, uint64_t>> NodeInformation::getTimeouts() const
+{
+    std::vector<std::pair<Node, uint64_t>> timeouts;
+    {
+        std::scoped_lock l{m_timeoutsMutex};
+        timeouts.assign(m_timeouts.begin(), m_timeouts.end());
+    }
+    std::sort(timeouts.begin(), timeouts.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+    return timeouts;
 }
 std::optional<std::vector<uint8_t>> NodeInformation::getData(const std::vector<uint8_t> &key) const
 {
-    std::shared_lock l{m_dataMutex};
-    return m_data.contains(key) ? m_data.at(key).first : std::optional<std::vector<uint8_t>>{};
+    std::shared_lock l{m_storage->mutex};
+    return m_storage->data.contains(key) ? m_storage->data.at(key).first : std::optional<std::vector<uint8_t>>{};
+}
+std::optional<NodeInformation::data_type::mapped_type>
+NodeInformation::getDataExpires(const std::vector<uint8_t> &key) const
+{
+    std::shared_lock l{m_storage->mutex};
+    auto it = m_storage->data.find(key);
+    return it != m_storage->data.end() ? it->second : std::optional<data_type::mapped_type>{};
 }
 void NodeInformation::setData(const std::vector<uint8_t> &key, const std::vector<uint8_t> &value,
                               std::chrono::system_clock::duration ttl)
@@ -132,8 +260,8 @@ void NodeInformation::setDataExpires(const std::vector<uint8_t> &key, const std:
         "setting data, key length: {}, value length: {}, expires: UTC-{:%H:%M:%S}",
         key.size(), value.size(), tm
     );
-    std::unique_lock l{m_dataMutex};
-    m_data[key] = std::make_pair(value, expires);
+    std::unique_lock l{m_storage->mutex};
+    m_storage->set(key, std::make_pair(value, expires));
 }
 std::optional<NodeInformation::Node> NodeInformation::getBootstrapNode() const
 {
@@ -147,32 +275,55 @@ std::optional<NodeInformation::data_type> NodeInformation::getDataItemsForNodeId
     const Node &newNode
 ) const
 {
-    std::shared_lock l{m_dataMutex};
+    auto new_id = newNode.getKey();
+    auto pred = getRouting()->predecessor;
+    auto pred_id = pred ? pred->getKey() : new_id;
     NodeInformation::data_type dataToReturn;
-    id_type new_id = newNode.getId();
-    auto pred = getPredecessor();
-    id_type pred_id = pred ? pred->getId() : new_id;
-    for (auto &s: m_data) {
-        const std::string strDataKey{s.first.begin(), s.first.end()};
-        id_type key_hash = util::hash_sha256(strDataKey);
-
-        if (util::is_in_range_loop(key_hash, pred_id, new_id, false, true)) {
-            dataToReturn.insert(s);
-        }
-    }
+    std::shared_lock l{m_storage->mutex};
+    m_storage->forEachInArc(pred_id, new_id, [&dataToReturn](const util::uint256 &, const auto &item) {
+        dataToReturn.insert(item);
+    });
     return dataToReturn;
 }
 
+std::vector<NodeInformation::StoredItem> NodeInformation::getStoredItems() const
+{
+    auto routing = getRouting();
+    // Without a predecessor, every item counts.
+    auto from = routing->predecessor ? routing->predecessor->getKey() : routing->self;
+    std::vector<StoredItem> items{};
+    std::shared_lock l{m_storage->mutex};
+    m_storage->forEachInArc(from, routing->self, [&items](const util::uint256 &id, const auto &item) {
+        items.push_back({id, item.first.size() + item.second.first.size()});
+    });
+    return items;
+}
+
+void NodeInformation::Storage::set(const std::vector<uint8_t> &key, data_type::mapped_type value)
+{
+    auto [it, inserted] = data.insert_or_assign(key, std::move(value));
+    if (inserted)
+        ids[util::uint256(util::hash_sha256(std::string{key.begin(), key.end()}))] = it;
+}
+
+NodeInformation::data_type::iterator NodeInformation::Storage::erase(data_type::iterator it)
+{
+    ids.erase(util::uint256(util::hash_sha256(std::string{it->first.begin(), it->first.end()})));
+    return data.erase(it);
+}
+
 NodeInformation::data_type NodeInformation::getAllDataInNode() const
 {
-    std::shared_lock l{m_dataMutex};
-    return m_data;
+    std::shared_lock l{m_storage->mutex};
+    return m_storage->data;
 }
 void NodeInformation::deleteDataAssignedToPredecessor(std::vector<std::vector<uint8_t>> &keyOfDataItemsToDelete)
 {
-    std::unique_lock l{m_dataMutex};
+    std::unique_lock l{m_storage->mutex};
     for (const auto &s: keyOfDataItemsToDelete) {
-        m_data.erase(s);
+        auto it = m_storage->data.find(s);
+        if (it != m_storage->data.end())
+            m_storage->erase(it);
     }
 }
 void NodeInformation::setReplicationIndex(const uint8_t &replicationIndex)
@@ -216,34 +367,157 @@ void NodeInformation::setReplicationLimitOnEachNode(uint8_t &replicationLimit){
 
 // Node Methods:
 
+NodeInformation::Node::Identity::Identity(const id_type &id) :
+    id(id), key(id), hash(static_cast<std::size_t>(key.words[0] ^ key.words[1] ^ key.words[2] ^ key.words[3]))
+{}
+
+std::shared_ptr<const NodeInformation::Node::Identity>
+NodeInformation::Node::Identity::intern(const std::string &ip, uint16_t port, uint16_t vnode)
+{
+    // Nodes decoded from a response are usually short-lived, so the table keeps its identities alive. Once it
+    // doubled in size, identities that only the table refers to are dropped.
+    static std::shared_mutex mutex{};
+    static std::unordered_map<std::string, std::shared_ptr<const Identity>> identities{};
+    static std::size_t pruneAt = 1024;
+
+    auto address = ip + ":" + std::to_string(port);
+    if (vnode != 0)
+        address += "#" + std::to_string(vnode);
+    {
+        std::shared_lock lock(mutex);
+        auto it = identities.find(address);
+        if (it != identities.end())
+            return it->second;
+    }
+
+    auto identity = std::make_shared<const Identity>(util::hash_sha256(address));
+    std::unique_lock lock(mutex);
+    auto [it, inserted] = identities.try_emplace(std::move(address), identity);
+    if (!inserted)
+        return it->second;
+    if (identities.size() >= pruneAt) {
+        std::erase_if(identities, [](const auto &item) { return item.second.use_count() == 1; });
+        pruneAt = std::max<std::size_t>(1024, 2 * identities.size());
+    }
+    return identity;
+}
+
 void NodeInformation::Node::setIp(std::string ip)
 {
     m_ip = std::move(ip);
-    id_valid = false;
+    m_identity.reset();
 }
 void NodeInformation::Node::setPort(uint16_t port)
 {
     m_port = port;
-    id_valid = false;
+    m_identity.reset();
 }
 void NodeInformation::Node::setId(std::optional<id_type> id)
 {
     m_explicit_id = id;
+    m_identity.reset();
 }
 
 std::string NodeInformation::Node::getIp() const { return m_ip; }
 uint16_t NodeInformation::Node::getPort() const { return m_port; }
+uint16_t NodeInformation::Node::getVnode() const { return m_vnode; }
 NodeInformation::id_type NodeInformation::Node::getId() const
 {
-    if (!id_valid) updateId();
-    return m_id;
+    return identity().id;
+}
+util::uint256 NodeInformation::Node::getKey() const
+{
+    return identity().key;
+}
+
+const NodeInformation::Node::Identity &NodeInformation::Node::identity() const
+{
+    if (!m_identity) updateId();
+    return *m_identity;
 }
 
 void NodeInformation::Node::updateId() const
 {
-    id_valid = true;
     if (m_explicit_id)
-        m_id = *m_explicit_id;
+        m_identity = std::make_shared<const Identity>(*m_explicit_id);
     else
-        m_id = util::hash_sha256(m_ip + ":" + std::to_string(m_port));
-}
\ No newline at end of file
+        m_identity = Identity::intern(m_ip, m_port, m_vnode);
+}
+
+// RoutingTable Methods:
+
+NodeInformation::node_handle NodeInformation::RoutingTable::closestPreceding(const util::uint256 &id) const
+{
+    // A finger f is in (self, id) iff 0 < distance(f) < distance(id). id == self means the whole ring.
+    auto limit = id - self;
+    auto end = limit.is_zero()
+               ? distinctDistances.end()
+               : std::lower_bound(distinctDistances.begin(), distinctDistances.end(), limit);
+    if (end == distinctDistances.begin())
+        return {};
+    return distinct[static_cast<size_t>(end - distinctDistances.begin() - 1)];
+}
+
+bool NodeInformation::RoutingTable::routesTo(const Node &node) const
+{
+    auto distance = node.getKey() - self;
+    return std::binary_search(distinctDistances.begin(), distinctDistances.end(), distance);
+}
+
+NodeInformation::node_handle NodeInformation::RoutingTable::intern(const Node &node) const
+{
+    auto id = node.getId();
+    auto same = [&](const node_handle &handle) {
+        return handle && handle->getId() == id && handle->getIp() == node.getIp() && handle->getPort() == node.getPort();
+    };
+    if (same(predecessor))
+        return predecessor;
+    for (const auto &finger: fingers)
+        if (same(finger)) return finger;
+    for (const auto &successor: successors)
+        if (same(successor)) return successor;
+    for (const auto &known: learned)
+        if (same(known)) return known;
+
+    auto handle = std::make_shared<const Node>(node);
+    // The identity is resolved lazily, do it before the node is shared between threads.
+    (void) handle->getId();
+    return handle;
+}
+
+void NodeInformation::RoutingTable::setFinger(size_t index, const std::optional<Node> &node)
+{
+    fingers[index] = node ? intern(*node) : node_handle{};
+    fingerIds[index] = node ? fingers[index]->getKey() : util::uint256{};
+}
+
+void NodeInformation::RoutingTable::rebuild()
+{
+    auto first = std::find_if(fingers.begin(), fingers.end(), [](const auto &finger) { return bool(finger); });
+    successor = first != fingers.end() ? *first : node_handle{};
+
+    std::vector<std::pair<util::uint256, node_handle>> sorted{};
+    for (size_t i = 0; i < key_bits; ++i) {
+        if (fingers[i] && fingerIds[i] != self)
+            sorted.emplace_back(fingerIds[i] - self, fingers[i]);
+    }
+    // Stable, a finger wins over a digit finger or learned node with the same id.
+    for (const auto &finger: digitFingers) {
+        if (finger && finger->getKey() != self)
+            sorted.emplace_back(finger->getKey() - self, finger);
+    }
+    for (const auto &known: learned) {
+        if (known->getKey() != self)
+            sorted.emplace_back(known->getKey() - self, known);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first == b.first; }),
+                 sorted.end());
+
+    distinct.clear();
+    distinctDistances.clear();
+    for (auto &[distance, finger]: sorted) {
+        distinctDistances.push_back(distance);
+        distinct.push_back(std::move(finger));
+    }
+}
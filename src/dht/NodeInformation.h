@@ -12,6 +12,11 @@
 #include <future>
 #include <numeric>
 #include <deque>
+#include <util.h>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 // Also declared in config.h.
 #define DEFAULT_DIFFICULTY 1
@@ -28,50 +33,56 @@ public:
     static constexpr size_t key_bits = SHA256_DIGEST_LENGTH * 8;
     using id_type = std::array<uint8_t, key_bits / 8>;
     using data_type = std::map<std::vector<uint8_t>, std::pair<std::vector<uint8_t>, std::chrono::system_clock::time_point>>;
+    /// Ring positions one address may take. Bounds how many ids a host can try to pick a position it likes.
+    static constexpr uint16_t max_vnodes = 256;
 
     class Node
     {
     public:
-        struct Node_hash
+        /**
+         * @brief
+         * Id, key and hash of a node. Identities derived from an address are interned process-wide, so the id of an
+         * address is hashed once, no matter how often the node appears in RPCs.
+         */
+        struct Identity
         {
+            id_type id;
+            util::uint256 key;
+            std::size_t hash;
+
+            explicit Identity(const id_type &id);
+
             /**
              * @brief
-             * interpret the array as if it consisted of size_t's by adding elements with increasing offsets.
-             * Once one size_t's worth of bytes was added, the result is xor-ed into the result.
-             * It is as if all the size_t's were xor-ed together.
-             * The important part is that if id.size() is not divisible by 8, this will still use all bytes.
+             * The shared identity of ip:port, computed on first use. Vnode i > 0 of the address hashes ip:port#i.
              */
+            static std::shared_ptr<const Identity> intern(const std::string &ip, uint16_t port, uint16_t vnode = 0);
+        };
+
+        struct Node_hash
+        {
             std::size_t operator()(const Node &node) const
             {
-                auto id = node.getId();
-                std::size_t ret = 0;
-                std::size_t tmp = 0;
-                for (uint32_t i = 0; i < id.size(); ++i) {
-                    tmp += static_cast<std::size_t>(id[i]) << (8 * (i % sizeof(std::size_t)));
-                    if ((i + 1) % sizeof(std::size_t) == 0) {
-                        ret ^= tmp;
-                        tmp = 0;
-                    }
-                }
-                ret ^= tmp;
-                return ret;
+                return node.identity().hash;
             }
         };
 
     private:
         std::string m_ip;
         uint16_t m_port;
+        /// Which of the ring positions of the process at ip:port this is, 0 for its main one.
+        uint16_t m_vnode{0};
 
-        mutable bool id_valid{true};
-        mutable id_type m_id{0};
+        /// Resolved lazily, reset whenever ip, port or the explicit id change.
+        mutable std::shared_ptr<const Identity> m_identity{};
 
         std::optional<id_type> m_explicit_id{};
     public:
-        explicit Node(std::string ip = "127.0.0.1", uint16_t port = 6969)
-            : m_ip(std::move(ip)), m_port(port) { updateId(); }
+        explicit Node(std::string ip = "127.0.0.1", uint16_t port = 6969, uint16_t vnode = 0)
+            : m_ip(std::move(ip)), m_port(port), m_vnode(vnode) { updateId(); }
 
         Node(std::string ip, uint16_t port, id_type id)
-            : m_ip(std::move(ip)), m_port(port), m_id(id), m_explicit_id(id) {}
+            : m_ip(std::move(ip)), m_port(port), m_identity(std::make_shared<const Identity>(id)), m_explicit_id(id) {}
 
         void setIp(std::string ip);
         void setPort(uint16_t port);
@@ -79,32 +90,136 @@ public:
 
         [[nodiscard]] std::string getIp() const;
         [[nodiscard]] uint16_t getPort() const;
+        [[nodiscard]] uint16_t getVnode() const;
         [[nodiscard]] id_type getId() const;
+        [[nodiscard]] util::uint256 getKey() const;
 
     private:
+        [[nodiscard]] const Identity &identity() const;
         void updateId() const;
 
     public:
-        bool operator==(const Node &other) const { return getId() == other.getId(); }
+        bool operator==(const Node &other) const { return identity().key == other.identity().key; }
         bool operator!=(const Node &other) const { return !(*this == other); }
     };
 
+    /// Shared, immutable node. Fingers that point to the same node share one handle.
+    using node_handle = std::shared_ptr<const Node>;
+
+    /**
+     * @brief
+     * Routing state as an immutable snapshot. Writers publish a modified copy, readers keep using the snapshot
+     * they loaded without taking any lock.
+     */
+    struct RoutingTable
+    {
+        /// Id of this node, distances below are measured clockwise from it.
+        util::uint256 self{};
+        /// m = number of bits in the id. Empty handles are unset fingers.
+        std::array<node_handle, key_bits> fingers{};
+        /// Id of every set finger, stored contiguously so that lookups scan ids without touching the nodes.
+        std::array<util::uint256, key_bits> fingerIds{};
+        /// First set finger.
+        node_handle successor{};
+        node_handle predecessor{};
+        /// The next nodes on the ring, closest first, as reported by the successor. Replaces a failed successor
+        /// without a lookup.
+        std::vector<node_handle> successors{};
+        /// Fingers of a table with a base larger than 2 that are not binary fingers, in the order of
+        /// FingerScheduler::digitOffsets. Empty handles are unset fingers.
+        std::vector<node_handle> digitFingers{};
+        /// Nodes met on the paths of lookups, oldest first. Routed to like fingers, but not maintained.
+        std::vector<node_handle> learned{};
+        /// Distinct fingers, digit fingers and learned nodes other than this node, sorted by their distance from self.
+        /// Most fingers point to the same few nodes, so this is much shorter than the finger table.
+        std::vector<node_handle> distinct{};
+        /// distinctDistances[i] is the distance of distinct[i] from self.
+        std::vector<util::uint256> distinctDistances{};
+
+        /**
+         * @return The finger closest to, but not including id, going backwards from id.
+         * Binary search over the distinct fingers, does not allocate.
+         */
+        [[nodiscard]] node_handle closestPreceding(const util::uint256 &id) const;
+        /**
+         * @return Whether closestPreceding can return node.
+         */
+        [[nodiscard]] bool routesTo(const Node &node) const;
+        /**
+         * @return The handle of a finger, the predecessor, a successor or a learned node for the same node, or a new
+         * one.
+         */
+        [[nodiscard]] node_handle intern(const Node &node) const;
+        void setFinger(size_t index, const std::optional<Node> &node);
+        /**
+         * @brief Recompute successor and the distinct fingers after fingers or self changed.
+         */
+        void rebuild();
+    };
+    using routing_snapshot = std::shared_ptr<const RoutingTable>;
+
+    /// An item of the data store, by the id of its key.
+    struct StoredItem
+    {
+        util::uint256 id;
+        /// Size of key and value.
+        uint64_t bytes;
+    };
+
 private:
     Node m_node;
-    std::vector<std::optional<Node>> m_fingerTable{key_bits}; // m = number of bits in the id
-    mutable std::shared_mutex m_fingerTableMutex{};
-    std::optional<Node> m_predecessor{};
-    mutable std::shared_mutex m_predecessorMutex{};
-    /// Stores data along with the expiry date.
-    data_type m_data{};
-    mutable std::shared_mutex m_dataMutex{};
-    /// Asynchronously removes expired data entries.
+    /// The node changes when a vnode moves to another position on the ring.
+    mutable std::shared_mutex m_nodeMutex{};
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::atomic<routing_snapshot> m_routing{std::make_shared<const RoutingTable>()};
+#else
+    /// Only accessed through std::atomic_load and std::atomic_store, std::atomic<shared_ptr> needs libstdc++ 12.
+    routing_snapshot m_routing{std::make_shared<const RoutingTable>()};
+#endif
+    /// Serializes writers of m_routing, readers never take it.
+    std::mutex m_routingWriteMutex{};
+    struct Storage
+    {
+        /// Stores data along with the expiry date.
+        data_type data{};
+        /// The items of data by the id of their key, ordered around the ring. Hashed once, when an item is written.
+        std::map<util::uint256, data_type::const_iterator> ids{};
+        mutable std::shared_mutex mutex{};
+
+        void set(const std::vector<uint8_t> &key, data_type::mapped_type value);
+        data_type::iterator erase(data_type::iterator it);
+
+        /**
+         * @brief Calls visit with every item whose id is in (from, to], the whole ring if from == to.
+         */
+        template<typename F>
+        void forEachInArc(const util::uint256 &from, const util::uint256 &to, F &&visit) const
+        {
+            auto walk = [&visit](auto first, auto last) {
+                for (; first != last; ++first)
+                    visit(first->first, *first->second);
+            };
+            if (from < to) {
+                walk(ids.upper_bound(from), ids.upper_bound(to));
+            } else {
+                // The arc wraps around 0.
+                walk(ids.upper_bound(from), ids.end());
+                walk(ids.begin(), ids.upper_bound(to));
+            }
+        }
+    };
+    /// Shared by all vnodes of a process.
+    std::shared_ptr<Storage> m_storage{std::make_shared<Storage>()};
+    /// Asynchronously removes expired data entries. Only runs on the node that created the storage.
     std::future<void> m_dataCleaner{};
     std::atomic_bool m_destroyed{false};
     mutable std::mutex m_cv_m{};
     std::condition_variable m_cv{};
     /// Bootstrap node details
     std::optional<Node> m_bootstrapNodeAddress{};
+    /// Number of RPCs to each peer that ran into their deadline.
+    std::unordered_map<Node, uint64_t, Node::Node_hash> m_timeouts{};
+    mutable std::mutex m_timeoutsMutex{};
 
     /* Used for DHT GET */
     static std::deque<uint8_t> m_allReplicationIndices;
@@ -142,24 +257,108 @@ public:
      * @throws std::out_of_range
      */
     void setFinger(size_t index, const std::optional<Node> &node = {});
+    /**
+     * @brief Sets fingers [first, last] to node, in one update.
+     * @throws std::out_of_range
+     */
+    void setFingers(size_t first, size_t last, const std::optional<Node> &node = {});
+    /**
+     * @brief Sets digit fingers [first, last] to node, in one update.
+     */
+    void setDigitFingers(size_t first, size_t last, const std::optional<Node> &node = {});
+    /**
+     * @return The finger closest to, but not including id, going backwards from id. Does not allocate.
+     */
+    [[nodiscard]] node_handle getClosestPreceding(const id_type &id) const;
+    /**
+     * @brief Current routing state. Use one snapshot for all routing decisions of a request.
+     */
+    [[nodiscard]] routing_snapshot getRouting() const;
 
-    [[nodiscard]] std::optional<Node> getSuccessor();
+    [[nodiscard]] std::optional<Node> getSuccessor() const;
+    [[nodiscard]] node_handle getSuccessorHandle() const;
     void setSuccessor(const std::optional<Node> &node = {});
     [[nodiscard]] std::optional<Node> getPredecessor() const;
     void setPredecessor(const std::optional<Node> &node = {});
+    [[nodiscard]] std::vector<Node> getSuccessorList() const;
+    void setSuccessorList(const std::vector<Node> &successors);
+    /**
+     * @brief
+     * Forgets a node that failed: it is removed from the fingers, the successor list and as predecessor.
+     * If it was the successor, the next entry of the successor list takes its place.
+     */
+    void removePeer(const Node &node);
+    /**
+     * @brief
+     * Adds nodes a lookup met to the learned nodes, which are routed to like fingers. Only the newest capacity
+     * learned nodes are kept. Does not update the routing state if every node is known already.
+     */
+    void learnNodes(const std::vector<Node> &nodes, size_t capacity);
+    /**
+     * @brief Counts an RPC to peer that was cancelled at its deadline.
+     */
+    void countTimeout(const Node &peer);
+    /**
+     * @return Peers with their number of timed out RPCs, most timeouts first
+     */
+    [[nodiscard]] std::vector<std::pair<Node, uint64_t>> getTimeouts() const;
 
     [[nodiscard]] std::optional<std::vector<uint8_t>> getData(const std::vector<uint8_t> &key) const;
+    /**
+     * @return The value of key and when it expires
+     */
+    [[nodiscard]] std::optional<data_type::mapped_type> getDataExpires(const std::vector<uint8_t> &key) const;
     void setData(const std::vector<uint8_t> &key, const std::vector<uint8_t> &value,
                  std::chrono::system_clock::duration ttl = std::chrono::system_clock::duration::max());
     void setDataExpires(const std::vector<uint8_t> &key, const std::vector<uint8_t> &value,
                         std::chrono::system_clock::time_point expires);
 
     [[nodiscard]] std::optional<NodeInformation::data_type> getDataItemsForNodeId(const Node &newNode) const;
+    /**
+     * @return The items of the data store this node is responsible for
+     */
+    [[nodiscard]] std::vector<StoredItem> getStoredItems() const;
     [[nodiscard]] NodeInformation::data_type getAllDataInNode() const;
     [[nodiscard]] void deleteDataAssignedToPredecessor(std::vector<std::vector<uint8_t>> &keyOfDataItemsToDelete);
+private:
+    /**
+     * @brief Let update modify the node, and move the routing state to its id.
+     */
+    template<typename F>
+    void updateNode(F &&update)
+    {
+        {
+            std::unique_lock l{m_nodeMutex};
+            update(m_node);
+            // Resolves the identity while no reader can see the node.
+            static_cast<void>(m_node.getKey());
+        }
+        updateRouting([](RoutingTable &) {});
+    }
+    /**
+     * @brief Copy the routing state, let update modify the copy and publish it.
+     */
+    template<typename F>
+    void updateRouting(F &&update)
+    {
+        std::scoped_lock l{m_routingWriteMutex};
+        auto routing = std::make_shared<RoutingTable>(*getRouting());
+        routing->self = getNode().getKey();
+        update(*routing);
+        routing->rebuild();
+#ifdef __cpp_lib_atomic_shared_ptr
+        m_routing.store(std::move(routing));
+#else
+        std::atomic_store(&m_routing, routing_snapshot{std::move(routing)});
+#endif
+    }
 public:
     // Constructor
     explicit NodeInformation(std::string host = "", uint16_t port = 0);
+    /**
+     * @brief Vnode vnode of the process of host. It shares the data of host, whose cleaner removes expired entries.
+     */
+    NodeInformation(const NodeInformation &host, uint16_t vnode);
     ~NodeInformation();
 
     // Getters and setters
@@ -1,5 +1,6 @@
 #include "Peer.h"
 #include <stack>
+#include <limits>
 #include <util.h>
 #include <centralLogControl.h>
 
@@ -9,10 +10,22 @@ using dht::Node;
 
 
 PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Configuration conf,
+                   std::shared_ptr<FailureDetector> failureDetector, std::shared_ptr<Membership> membership,
                    GetSuccessorMethod getSuccessorMethod) :
     m_getSuccessorMethod{getSuccessorMethod},
     m_nodeInformation{std::move(nodeInformation)},
-    m_conf{std::move(conf)} {}
+    m_conf{std::move(conf)},
+    m_failureDetector{std::move(failureDetector)},
+    m_membership{std::move(membership)},
+    m_process{std::make_shared<std::vector<PeerImpl *>>(1, this)},
+    m_requests{std::chrono::milliseconds(std::max<uint64_t>(1, m_conf.rebalance_interval))},
+    m_verificationPolicy{
+        m_conf.verify_successor == "always" ? VerificationPolicy::ALWAYS
+        : m_conf.verify_successor == "sampled" ? VerificationPolicy::SAMPLED
+        : m_conf.verify_successor == "never" ? VerificationPolicy::NEVER
+        : VerificationPolicy::FINAL_HOP
+    },
+    m_verificationSample{static_cast<double>(m_conf.verify_sample_percent) / 100.0} {}
 
 // Server methods
 
@@ -20,39 +33,44 @@ PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Con
 {
     SPDLOG_TRACE("received getSuccessor request");
     auto id = idFromReader(context.getParams().getId());
-    return getSuccessor(id).then([KJ_CPCAP(context)](const std::optional<NodeInformation::Node> &successor) mutable {
-        if (!successor) {
-            context.getResults().getNode().setEmpty();
-        } else {
-            auto node = context.getResults().getNode().getValue();
-            node.setIp(successor->getIp());
-            node.setPort(successor->getPort());
-            auto id = successor->getId();
-            node.setId(
-                capnp::Data::Builder(kj::heapArray<kj::byte>(id.begin(), id.end())));
-        }
+    auto deadline = clock_type::now() + std::chrono::milliseconds(m_conf.lookup_timeout);
+    // The caller gives up after its budget, there is no point in answering later.
+    if (auto budget = context.getParams().getBudget(); budget > 0)
+        deadline = std::min(deadline, clock_type::now() + std::chrono::milliseconds(budget));
+    return getSuccessor(id, deadline).then([KJ_CPCAP(context)](const std::optional<NodeInformation::Node> &successor) mutable {
+        buildNode(context.getResults().getNode(), successor);
     });
 }
 
 ::kj::Promise<void> PeerImpl::getClosestPreceding(GetClosestPrecedingContext context)
 {
     auto id = idFromReader(context.getParams().getId());
-    buildNode(context.getResults().getPreceding(), getClosestPreceding(id));
-    buildNode(context.getResults().getDirectSuccessor(), m_nodeInformation->getSuccessor());
+    auto routing = m_nodeInformation->getRouting();
+    buildNode(context.getResults().getPreceding(), routing->closestPreceding(util::uint256(id)));
+    buildNode(context.getResults().getDirectSuccessor(), routing->successor);
     return kj::READY_NOW;
 }
 
 ::kj::Promise<void> PeerImpl::getPredecessor(GetPredecessorContext context)
 {
     SPDLOG_TRACE("received getPredecessor request");
-    auto pred = m_nodeInformation->getPredecessor();
-    if (pred) {
-        auto node = context.getResults().getNode().getValue();
-        node.setIp(pred->getIp());
-        node.setPort(pred->getPort());
-        node.setId(containerToArray<kj::byte>(pred->getId()));
-    } else {
-        context.getResults().getNode().setEmpty();
+    auto routing = m_nodeInformation->getRouting();
+    buildNode(context.getResults().getNode(), routing->predecessor);
+
+    // Piggybacked for the caller's successor list.
+    if (!routing->successors.empty()) {
+        auto successors = context.getResults().initSuccessors(static_cast<unsigned>(routing->successors.size()));
+        for (unsigned i = 0; i < successors.size(); ++i)
+            buildNode(successors[i], *routing->successors[i]);
+    } else if (routing->successor) {
+        buildNode(context.getResults().initSuccessors(1)[0], *routing->successor);
+    }
+
+    // Pings carry no gossip and get none back, the changes are only counted as sent when they are.
+    if (m_membership && context.getParams().hasGossip()) {
+        m_membership->merge(membersFromReader(context.getParams().getGossip()));
+        auto gossip = m_membership->gossip();
+        buildMembers(context.getResults().initGossip(static_cast<unsigned>(gossip.size())), gossip);
     }
     return kj::READY_NOW;
 }
@@ -62,13 +80,16 @@ PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Con
     SPDLOG_TRACE("received notify request");
 
     auto node = nodeFromReader(context.getParams().getNode());
-    auto pred = m_nodeInformation->getPredecessor();
+    m_failureDetector->heard(node);
+    if (m_membership)
+        m_membership->merge(membersFromReader(context.getParams().getGossip()));
+    auto pred = m_nodeInformation->getRouting()->predecessor;
 
     if (!pred ||
         util::is_in_range_loop(
-            node.getId(),
-            pred->getId(),
-            m_nodeInformation->getId(),
+            node.getKey(),
+            pred->getKey(),
+            m_nodeInformation->getRouting()->self,
             false, false
         )) {
         m_nodeInformation->setPredecessor(node);
@@ -80,12 +101,15 @@ PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Con
 ::kj::Promise<void> PeerImpl::getData(GetDataContext context)
 {
     SPDLOG_TRACE("received getData request");
+    m_requests.add();
 
     std::vector<uint8_t> key{context.getParams().getKey().begin(), context.getParams().getKey().end()};
-    auto value = m_nodeInformation->getData(key);
-    if (value) {
+    auto item = m_nodeInformation->getDataExpires(key);
+    if (item) {
         context.getResults().getData().setValue(
-            capnp::Data::Builder(kj::heapArray<kj::byte>(value->begin(), value->end())));
+            capnp::Data::Builder(kj::heapArray<kj::byte>(item->first.begin(), item->first.end())));
+        context.getResults().setExpires(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::seconds>(item->second.time_since_epoch()).count()));
     } else {
         context.getResults().getData().setEmpty();
     }
@@ -95,6 +119,7 @@ PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Con
 ::kj::Promise<void> PeerImpl::setData(SetDataContext context)
 {
     SPDLOG_TRACE("received setData request");
+    m_requests.add();
 
     // TODO: only store if this node is responsible for the key.
     //       But we'll deal with hardening against attacks later.
@@ -117,9 +142,13 @@ PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Con
 {
     /* Check if current node is predecessor of node in GetDataItemsOnJoinParams */
     auto newNode = nodeFromReader(context.getParams().getNewNode());
+    auto routing = m_nodeInformation->getRouting();
+    if (!routing->predecessor) {
+        SPDLOG_INFO("No predecessor to check the new node against.");
+        return kj::READY_NOW;
+    }
 
-    if (!util::is_in_range_loop(newNode.getId(), m_nodeInformation->getPredecessor()->getId(),
-                                m_nodeInformation->getId(), false, false)) {
+    if (!util::is_in_range_loop(newNode.getKey(), routing->predecessor->getKey(), routing->self, false, false)) {
         SPDLOG_INFO("New Node must be in between predecessor an this node.");
         return kj::READY_NOW;
     }
@@ -127,14 +156,16 @@ PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Con
     /* Get data items for which predecessor of current node is responsible. */
     auto dataForNewNode = m_nodeInformation->getDataItemsForNodeId(newNode);
 
-    /* Delete data items from current node which have been assigned to predecessor. */
-    std::vector<std::vector<uint8_t>> keyOfDataItemsAssignedToPredecessor;
-    for (const auto &s: *dataForNewNode) {
-        keyOfDataItemsAssignedToPredecessor.push_back(s.first);
-    }
-    m_nodeInformation->deleteDataAssignedToPredecessor(keyOfDataItemsAssignedToPredecessor);
-
     if (dataForNewNode) {
+        /* Delete data items from current node which have been assigned to predecessor. */
+        if (!context.getParams().getKeep()) {
+            std::vector<std::vector<uint8_t>> keyOfDataItemsAssignedToPredecessor;
+            for (const auto &s: *dataForNewNode) {
+                keyOfDataItemsAssignedToPredecessor.push_back(s.first);
+            }
+            m_nodeInformation->deleteDataAssignedToPredecessor(keyOfDataItemsAssignedToPredecessor);
+        }
+
         auto iter = dataForNewNode->begin();
 
         auto s = context.getResults().initListOfDataItems(static_cast<kj::uint>(dataForNewNode->size()));
@@ -206,15 +237,151 @@ PeerImpl::PeerImpl(std::shared_ptr<NodeInformation> nodeInformation, config::Con
         });
 }
 
+::kj::Promise<void> PeerImpl::findSuccessorDirect(FindSuccessorDirectContext context)
+{
+    SPDLOG_TRACE("received findSuccessorDirect request");
+    auto params = context.getParams();
+    auto deadline = clock_type::now() + std::chrono::milliseconds(m_conf.lookup_timeout);
+    if (auto budget = params.getBudget(); budget > 0)
+        deadline = std::min(deadline, clock_type::now() + std::chrono::milliseconds(budget));
+    routeDirect(idFromReader(params.getId()), deadline, nodeFromReader(params.getOrigin()), params.getLookup());
+    return kj::READY_NOW;
+}
+
+::kj::Promise<void> PeerImpl::deliver(DeliverContext context)
+{
+    SPDLOG_TRACE("received deliver request");
+    resolveLookup(context.getParams().getLookup(), nodeFromReader(context.getParams().getNode()));
+    return kj::READY_NOW;
+}
+
+::kj::Promise<void> PeerImpl::getMembers(GetMembersContext context)
+{
+    SPDLOG_TRACE("received getMembers request");
+    if (m_membership) {
+        auto members = m_membership->members();
+        buildMembers(context.getResults().initMembers(static_cast<unsigned>(members.size())), members);
+    }
+    return kj::READY_NOW;
+}
+
+::kj::Promise<void> PeerImpl::getVnode(GetVnodeContext context)
+{
+    SPDLOG_TRACE("received getVnode request");
+    auto index = context.getParams().getIndex();
+    for (auto *peer: *m_process) {
+        if (peer->m_nodeInformation->getNode().getVnode() == index) {
+            context.getResults().setPeer(peer->thisCap());
+            return kj::READY_NOW;
+        }
+    }
+    return KJ_EXCEPTION(FAILED, "no such vnode", index);
+}
+
+::kj::Promise<void> PeerImpl::getLoad(GetLoadContext context)
+{
+    SPDLOG_TRACE("received getLoad request");
+    context.getResults().setLoad(load());
+    return kj::READY_NOW;
+}
+
+::kj::Promise<void> PeerImpl::takeOver(TakeOverContext context)
+{
+    LOG_GET
+    SPDLOG_TRACE("received takeOver request");
+    context.getResults().getNode().setEmpty();
+    auto node = nodeFromReader(context.getParams().getNode());
+    auto split = util::uint256(idFromReader(context.getParams().getSplit()));
+    auto self = m_nodeInformation->getNode();
+    auto routing = m_nodeInformation->getRouting();
+
+    // The id is derived from the address, a node moves by taking another vnode index. Vnode 0 is the main interface
+    // of the process and stays, with full_membership the old position would linger in every membership.
+    if (self.getVnode() == 0 || m_membership || m_conf.rebalance_interval == 0)
+        return kj::READY_NOW;
+    if (!routing->successor || *routing->successor != node ||
+        !util::is_in_range_loop(split, routing->self, node.getKey(), false, false))
+        return kj::READY_NOW;
+    // Taking over at most one arc per interval bounds the bandwidth this node migrates.
+    if (m_lastMove && clock_type::now() - *m_lastMove < std::chrono::milliseconds(m_conf.rebalance_interval))
+        return kj::READY_NOW;
+
+    std::vector<NodeInformation::Node> free{};
+    std::vector<util::uint256> candidates{};
+    for (uint16_t index = 1; index < NodeInformation::max_vnodes; ++index) {
+        if (std::any_of(m_process->begin(), m_process->end(), [index](PeerImpl *peer) {
+            return peer->m_nodeInformation->getNode().getVnode() == index;
+        }))
+            continue;
+        free.emplace_back(self.getIp(), self.getPort(), index);
+        candidates.push_back(free.back().getKey());
+    }
+    auto position = LoadBalancer::position(routing->self, split, candidates);
+    if (!position) {
+        LOG_DEBUG("no free vnode index before the split");
+        return kj::READY_NOW;
+    }
+    auto moved = free[*position];
+    m_lastMove = clock_type::now();
+    LOG_INFO("moving from vnode {} to vnode {} to take load off {}:{}", self.getVnode(), moved.getVnode(),
+             node.getIp(), node.getPort());
+
+    /* Like a joining node, the new position takes its items over from the successor. The successor keeps them until
+     * it gets the answer to takeOver, and this node stays where it is until it holds them, so a failed move loses
+     * nothing. */
+    auto client = getClient(node.getIp(), node.getPort());
+    auto &timer = client->getIoProvider().getTimer();
+    auto req = getPeer(*client, node).getDataItemsOnJoinRequest();
+    buildNode(req.getNewNode(), moved);
+    req.setKeep(true);
+    auto deadline = clock_type::now() + std::chrono::milliseconds(m_conf.lookup_timeout);
+    return withDeadline(timer, node, req.send(), deadline).attach(kj::mv(client)).then(
+        [LOG_CAPTURE, this, KJ_CPCAP(context), self, moved](
+            capnp::Response<Peer::GetDataItemsOnJoinResults> &&response) mutable {
+            for (auto item: response.getListOfDataItems()) {
+                std::chrono::system_clock::time_point expires{std::chrono::seconds{item.getExpires()}};
+                m_nodeInformation->setDataExpires({item.getKey().begin(), item.getKey().end()},
+                                                  {item.getData().begin(), item.getData().end()}, expires);
+            }
+            // Another vnode of this process may have moved in the meantime.
+            if (m_nodeInformation->getNode() != self ||
+                std::any_of(m_process->begin(), m_process->end(), [&moved](PeerImpl *peer) {
+                    return peer->m_nodeInformation->getNode().getVnode() == moved.getVnode();
+                })) {
+                LOG_DEBUG("vnode {} was taken while the items were pulled", moved.getVnode());
+                return;
+            }
+            m_nodeInformation->setNode(moved);
+            if (m_onMove)
+                m_onMove();
+            buildNode(context.getResults().getNode(), moved);
+        }, [LOG_CAPTURE](kj::Exception &&e) {
+            // The successor kept the items and this node did not move yet, there is nothing to undo.
+            LOG_DEBUG("taking over items failed, staying\n\t\t{}", e.getDescription().cStr());
+        });
+}
+
+uint64_t PeerImpl::load()
+{
+    if (m_conf.load_metric == "requests")
+        return m_requests.rate();
+    uint64_t bytes = 0;
+    for (const auto &item: m_nodeInformation->getStoredItems())
+        bytes += item.bytes;
+    return bytes;
+}
+
 // Conversion
 
 NodeInformation::Node PeerImpl::nodeFromReader(Node::Reader value)
 {
+    // The id on the wire is not trusted, it is derived from the address. The identity of an address is interned,
+    // so only the first response that mentions a node hashes.
+    KJ_REQUIRE(value.getVnode() < NodeInformation::max_vnodes, "vnode out of range", value.getVnode());
     return NodeInformation::Node{
         value.getIp(),
-        value.getPort()
-        //
-        //, idFromReader(value.getId())
+        value.getPort(),
+        value.getVnode()
     };
 }
 
@@ -225,10 +392,29 @@ std::optional<NodeInformation::Node> PeerImpl::nodeFromReader(Optional<Node>::Re
     return nodeFromReader(node.getValue());
 }
 
+std::vector<dht::Membership::Member> PeerImpl::membersFromReader(capnp::List<Member>::Reader members)
+{
+    std::vector<Membership::Member> result{};
+    result.reserve(members.size());
+    for (auto member: members)
+        result.push_back({nodeFromReader(member.getNode()), member.getAlive(), member.getIncarnation()});
+    return result;
+}
+
+void PeerImpl::buildMembers(capnp::List<Member>::Builder builder, const std::vector<Membership::Member> &members)
+{
+    for (unsigned i = 0; i < builder.size(); ++i) {
+        buildNode(builder[i].getNode(), members[i].node);
+        builder[i].setAlive(members[i].alive);
+        builder[i].setIncarnation(members[i].incarnation);
+    }
+}
+
 void PeerImpl::buildNode(Node::Builder builder, const NodeInformation::Node &node)
 {
     builder.setIp(node.getIp());
     builder.setPort(node.getPort());
+    builder.setVnode(node.getVnode());
     builder.setId(containerToArray<kj::byte>(node.getId()));
 }
 
@@ -240,6 +426,14 @@ void PeerImpl::buildNode(Optional<Node>::Builder builder, const std::optional<No
         builder.setEmpty();
 }
 
+void PeerImpl::buildNode(Optional<Node>::Builder builder, const NodeInformation::node_handle &node)
+{
+    if (node)
+        buildNode(builder.getValue(), *node);
+    else
+        builder.setEmpty();
+}
+
 NodeInformation::id_type PeerImpl::idFromReader(capnp::Data::Reader id)
 {
     NodeInformation::id_type ret{};
@@ -252,35 +446,50 @@ NodeInformation::id_type PeerImpl::idFromReader(capnp::Data::Reader id)
 // Interface
 
 ::kj::Promise<std::optional<NodeInformation::Node>> PeerImpl::getSuccessor(NodeInformation::id_type id)
+{
+    return getSuccessor(id, clock_type::now() + std::chrono::milliseconds(m_conf.lookup_timeout));
+}
+
+::kj::Promise<std::optional<NodeInformation::Node>>
+PeerImpl::getSuccessor(NodeInformation::id_type id, clock_type::time_point deadline)
 {
     LOG_GET
 
+    // All routing decisions of this request are made on one snapshot, without taking any lock.
+    auto routing = m_nodeInformation->getRouting();
+    auto key = util::uint256(id);
+
     // If this node is requested
-    auto pred = m_nodeInformation->getPredecessor();
+    const auto &pred = routing->predecessor;
     if (pred &&
         util::is_in_range_loop(
-            id,
-            pred->getId(), m_nodeInformation->getId(),
+            key,
+            pred->getKey(), routing->self,
             false, true
         )) {
         return std::optional<NodeInformation::Node>{m_nodeInformation->getNode()};
     }
 
     // If next node is requested
-    auto successor = m_nodeInformation->getSuccessor();
+    auto successor = routing->successor;
     if (successor &&
         util::is_in_range_loop(
-            id,
-            m_nodeInformation->getId(), successor->getId(),
+            key,
+            routing->self, successor->getKey(),
             false, true
         )) {
-        // Check if successor is online
+        // Check if successor is online, unless it answered recently
+        if (m_failureDetector->verdict(*successor) == FailureDetector::Verdict::ALIVE) {
+            return std::optional<NodeInformation::Node>{*successor};
+        }
         auto client = getClient(successor->getIp(), successor->getPort());
-        auto cap = client->getMain<Peer>();
+        auto &timer = client->getIoProvider().getTimer();
+        auto cap = getPeer(*client, *successor);
         auto req = cap.getPredecessorRequest();
-        return req.send().then(
-            [client = kj::mv(client), successor](capnp::Response<Peer::GetPredecessorResults> &&) {
-                return successor;
+        return withDeadline(timer, *successor, req.send(), std::min(rpcDeadline(), deadline))
+            .attach(kj::mv(client)).then(
+            [successor](capnp::Response<Peer::GetPredecessorResults> &&) {
+                return std::optional<NodeInformation::Node>{*successor};
             }, [LOG_CAPTURE](const kj::Exception &e) {
                 LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
                 return std::optional<NodeInformation::Node>{};
@@ -290,22 +499,57 @@ NodeInformation::id_type PeerImpl::idFromReader(capnp::Data::Reader id)
 
     if (m_getSuccessorMethod == GetSuccessorMethod::PASS_ON) {
         // Otherwise, pass the request to the closest preceding finger
-        auto closest_preceding = getClosestPreceding(id);
+        auto closest_preceding = routing->closestPreceding(key);
 
         if (!closest_preceding) {
             return std::optional<NodeInformation::Node>{};
         }
 
+        // The next node may use what is left of our time, and no more.
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock_type::now()).count();
+        if (remaining <= 0) {
+            return std::optional<NodeInformation::Node>{};
+        }
+
         auto client = getClient(closest_preceding->getIp(), closest_preceding->getPort());
-        auto cap = client->getMain<Peer>();
+        auto &timer = client->getIoProvider().getTimer();
+        auto cap = getPeer(*client, *closest_preceding);
         auto req = cap.getSuccessorRequest();
         req.setId(capnp::Data::Builder{kj::heapArray<kj::byte>(id.begin(), id.end())});
-        return req.send().attach(kj::mv(client)).then([](capnp::Response<Peer::GetSuccessorResults> &&response) {
-            return nodeFromReader(response.getNode());
-        }, [LOG_CAPTURE](const kj::Exception &e) {
-            LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
-            return std::optional<NodeInformation::Node>{};
-        });
+        req.setBudget(static_cast<uint32_t>(std::min<int64_t>(remaining, std::numeric_limits<uint32_t>::max())));
+        return withDeadline(timer, *closest_preceding, req.send(), deadline).attach(kj::mv(client)).then(
+            [this](capnp::Response<Peer::GetSuccessorResults> &&response) {
+                auto node = nodeFromReader(response.getNode());
+                if (node)
+                    m_nodeInformation->learnNodes({*node}, m_conf.neighbor_cache_size);
+                return node;
+            }, [LOG_CAPTURE](const kj::Exception &e) {
+                LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
+                return std::optional<NodeInformation::Node>{};
+            }
+        );
+    }
+
+    if (m_getSuccessorMethod == GetSuccessorMethod::DIRECT) {
+        // The lookup travels on its own, the responsible node calls deliver on this node.
+        auto lookup = m_random();
+        auto paf = kj::newPromiseAndFulfiller<std::optional<NodeInformation::Node>>();
+        m_pendingLookups.emplace(lookup, kj::mv(paf.fulfiller));
+        routeDirect(id, deadline, m_nodeInformation->getNode(), lookup);
+
+        auto context = rpc::SecureRpcContext::getThreadLocal();
+        auto &timer = context->getIoProvider().getTimer();
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock_type::now()).count();
+        return paf.promise.then([this](std::optional<NodeInformation::Node> &&node) {
+            if (node)
+                m_nodeInformation->learnNodes({*node}, m_conf.neighbor_cache_size);
+            return kj::mv(node);
+        }).exclusiveJoin(
+            timer.afterDelay(std::max<int64_t>(0, remaining) * kj::MILLISECONDS).then([LOG_CAPTURE, lookup]() {
+                LOG_DEBUG("lookup {} was not delivered in time", lookup);
+                return std::optional<NodeInformation::Node>{};
+            })
+        ).attach(kj::defer([this, lookup]() { m_pendingLookups.erase(lookup); }), kj::mv(context));
     }
 
     // Core Algorithm of Chord
@@ -315,23 +559,36 @@ NodeInformation::id_type PeerImpl::idFromReader(capnp::Data::Reader id)
     // NOTE: this could be initialized using the rating system.
     //   i.e.: With 50 random nodes from the 1000 worst rated nodes.
     //   At the end, this set can be sent to the rating server.
+    // Every node the lookup was referred to, they are learned once the lookup succeeds.
+    auto met = std::make_shared<std::vector<NodeInformation::Node>>();
 
-    auto getSuccessorAlgorithm = [LOG_CAPTURE, this, id, hops, distrusted](
+    auto getSuccessorAlgorithm = [LOG_CAPTURE, this, id, hops, distrusted, met, deadline](
         auto getSuccessorAlgorithm
     ) mutable -> kj::Promise<std::optional<NodeInformation::Node>> {
         if (hops->empty())
             return std::optional<NodeInformation::Node>{};
+        if (clock_type::now() >= deadline) {
+            LOG_DEBUG("lookup of [{}] exceeded its deadline after {} hops", util::hexdump(id, 32, false, false),
+                      hops->size());
+            return std::optional<NodeInformation::Node>{};
+        }
         auto current = hops->top();
-        return getClosestPrecedingHelper(current, id, distrusted).then(
-            [LOG_CAPTURE, this, getSuccessorAlgorithm, id, hops, distrusted, current](
+        return getClosestPrecedingHelper(current, id, distrusted, deadline).then(
+            [LOG_CAPTURE, this, getSuccessorAlgorithm, id, hops, distrusted, met, current](
                 ClosestPrecedingPair &&result) mutable -> kj::Promise<std::optional<NodeInformation::Node>> {
                 // In between node has been found:
                 if (result.closestPreceding) {
                     hops->push(*result.closestPreceding);
+                    met->push_back(*result.closestPreceding);
                     return getSuccessorAlgorithm(getSuccessorAlgorithm);
                 }
                 // Responsible node has been found:
-                if (result.successor) return result.successor;
+                if (result.successor) {
+                    std::erase_if(*met, [&](const auto &node) { return distrusted->contains(node); });
+                    met->push_back(*result.successor);
+                    m_nodeInformation->learnNodes(*met, m_conf.neighbor_cache_size);
+                    return result.successor;
+                }
                 distrusted->insert(current);
                 hops->pop();
                 return getSuccessorAlgorithm(getSuccessorAlgorithm);
@@ -344,45 +601,48 @@ NodeInformation::id_type PeerImpl::idFromReader(capnp::Data::Reader id)
 
 std::optional<NodeInformation::Node> PeerImpl::getClosestPreceding(NodeInformation::id_type id)
 {
-    for (size_t i = NodeInformation::key_bits; i >= 1ull; --i) {
-        auto finger = m_nodeInformation->getFinger(i - 1);
-        if (finger && util::is_in_range_loop(
-            finger->getId(), m_nodeInformation->getId(), id,
-            false, false
-        ))
-            return finger;
-    }
-    return {};
+    auto finger = m_nodeInformation->getClosestPreceding(id);
+    return finger ? std::optional<NodeInformation::Node>{*finger} : std::optional<NodeInformation::Node>{};
 }
 
 std::optional<std::vector<uint8_t>>
 PeerImpl::getData(const NodeInformation::Node &node, const std::vector<uint8_t> &key)
 {
+    auto item = getDataExpires(node, key);
+    return item ? std::optional<std::vector<uint8_t>>{std::move(item->first)} : std::optional<std::vector<uint8_t>>{};
+}
+
+std::optional<NodeInformation::data_type::mapped_type>
+PeerImpl::getDataExpires(const NodeInformation::Node &node, const std::vector<uint8_t> &key)
+{
+    using item_type = std::optional<NodeInformation::data_type::mapped_type>;
     LOG_GET
     if (node == m_nodeInformation->getNode()) {
         LOG_TRACE("Get from this node");
-        return m_nodeInformation->getData(key);
+        return m_nodeInformation->getDataExpires(key);
     } else {
         auto client = getClient(node.getIp(), node.getPort());
-        auto cap = client->getMain<Peer>();
+        auto cap = getPeer(*client, node);
         auto req = cap.getDataRequest();
         req.setKey(capnp::Data::Builder(kj::heapArray<kj::byte>(key.begin(), key.end())));
-        return req.send().then([LOG_CAPTURE](capnp::Response<Peer::GetDataResults> &&response) {
+        auto &timer = client->getIoProvider().getTimer();
+        return withDeadline(timer, node, req.send(), rpcDeadline()).then([LOG_CAPTURE](capnp::Response<Peer::GetDataResults> &&response) {
             auto data = response.getData();
 
             if (data.which() == Optional<capnp::Data>::EMPTY) {
-                return std::optional<std::vector<uint8_t>>{};
+                return item_type{};
             }
             LOG_TRACE("Got Data");
-            return std::optional<std::vector<uint8_t>>{{data.getValue().begin(), data.getValue().end()}};
+            std::chrono::system_clock::time_point expires{std::chrono::seconds{response.getExpires()}};
+            return item_type{{{data.getValue().begin(), data.getValue().end()}, expires}};
         }, [LOG_CAPTURE](const kj::Exception &e) {
             LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
-            return std::optional<std::vector<uint8_t>>{};
+            return item_type{};
         }).wait(client->getWaitScope());
     }
 }
 
-void PeerImpl::setData(
+bool PeerImpl::setData(
     const NodeInformation::Node &node,
     const std::vector<uint8_t> &key, const std::vector<uint8_t> &value,
     uint16_t ttl)
@@ -395,17 +655,21 @@ void PeerImpl::setData(
     if (node == m_nodeInformation->getNode()) {
         LOG_TRACE("Store in this node");
         m_nodeInformation->setData(key, value, ttl_seconds);
+        return true;
     } else {
         auto client = getClient(node.getIp(), node.getPort());
-        auto cap = client->getMain<Peer>();
+        auto cap = getPeer(*client, node);
         auto req = cap.setDataRequest();
         req.setKey(capnp::Data::Builder(kj::heapArray<kj::byte>(key.begin(), key.end())));
         req.setValue(capnp::Data::Builder(kj::heapArray<kj::byte>(value.begin(), value.end())));
         req.setTtl(ttl);
-        return req.send().then([LOG_CAPTURE](capnp::Response<Peer::SetDataResults> &&) {
+        auto &timer = client->getIoProvider().getTimer();
+        return withDeadline(timer, node, req.send(), rpcDeadline()).then([LOG_CAPTURE](capnp::Response<Peer::SetDataResults> &&) {
             LOG_TRACE("got response");
+            return true;
         }, [LOG_CAPTURE](const kj::Exception &e) {
             LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
+            return false;
         }).wait(client->getWaitScope());
     }
 }
@@ -414,40 +678,53 @@ void PeerImpl::setData(
 
 ::kj::Promise<PeerImpl::ClosestPrecedingPair>
 PeerImpl::getClosestPrecedingHelper(const NodeInformation::Node &node, const NodeInformation::id_type &id,
-                                    const std::shared_ptr<std::unordered_set<NodeInformation::Node, NodeInformation::Node::Node_hash>> &distrusted)
+                                    const std::shared_ptr<std::unordered_set<NodeInformation::Node, NodeInformation::Node::Node_hash>> &distrusted,
+                                    clock_type::time_point deadline)
 {
     LOG_GET;
-    auto checkResult = [LOG_CAPTURE, this, node, distrusted, id](
+    auto checkResult = [LOG_CAPTURE, this, node, distrusted, id, deadline](
         ClosestPrecedingPair result) mutable -> ::kj::Promise<PeerImpl::ClosestPrecedingPair> {
         // Verify that preceding is between the asked node and the requested id,
         // and if directSuccessor is populated, make sure it is responsible for the id!
         if (result.closestPreceding &&
-            !util::is_in_range_loop(result.closestPreceding->getId(), node.getId(), id, false, false)) {
+            !util::is_in_range_loop(result.closestPreceding->getKey(), node.getKey(), util::uint256(id), false, false)) {
             LOG_INFO("Returned closest preceding is not in between node and id!");
             result.closestPreceding.reset();
         }
         if (result.successor && *result.successor == m_nodeInformation->getNode()) {
             result.successor.reset();
+        } else if (result.successor && !needsVerification(!result.closestPreceding)) {
+            ++m_verificationsSkipped;
         } else if (result.successor) {
+            ++m_verificationsPerformed;
             auto client = getClient(result.successor->getIp(), result.successor->getPort());
-            auto cap = client->getMain<Peer>();
+            auto &timer = client->getIoProvider().getTimer();
+            auto cap = getPeer(*client, *result.successor);
             auto req = cap.getPredecessorRequest();
-            return req.send().attach(kj::mv(client)).then(
-                [LOG_CAPTURE, node, id, result](capnp::Response<Peer::GetPredecessorResults> &&res) mutable {
+            return withDeadline(timer, *result.successor, req.send(), std::min(rpcDeadline(), deadline))
+                .attach(kj::mv(client)).then(
+                [LOG_CAPTURE, this, node, id, result](capnp::Response<Peer::GetPredecessorResults> &&res) mutable {
                     auto pred = nodeFromReader(res.getNode());
-                    if (!pred || (pred && !util::is_in_range_loop(id, pred->getId(), node.getId(), false, true))) {
+                    if (!pred || (pred && !util::is_in_range_loop(util::uint256(id), pred->getKey(), node.getKey(), false, true))) {
                         LOG_INFO("Returned direct successor is not responsible for the id [{}]!",
                                  util::hexdump(id, 32, false, false));
                         result.successor.reset();
+                        ++m_verificationsFailed;
                     }
                     return result;
+                }, [LOG_CAPTURE, this, result](kj::Exception &&e) mutable {
+                    // A successor that cannot be verified is not trusted either.
+                    LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
+                    result.successor.reset();
+                    ++m_verificationsFailed;
+                    return result;
                 }
             );
         }
         return result;
     };
 
-    auto impl = [LOG_CAPTURE, this, node, distrusted, checkResult](
+    auto impl = [LOG_CAPTURE, this, node, distrusted, checkResult, deadline](
         const NodeInformation::id_type &id) mutable -> ::kj::Promise<PeerImpl::ClosestPrecedingPair> {
 
         if (node == m_nodeInformation->getNode()) {
@@ -457,10 +734,11 @@ PeerImpl::getClosestPrecedingHelper(const NodeInformation::Node &node, const Nod
             });
         } else {
             auto client = getClient(node.getIp(), node.getPort());
-            auto cap = client->getMain<Peer>();
+            auto &timer = client->getIoProvider().getTimer();
+            auto cap = getPeer(*client, node);
             auto req = cap.getClosestPrecedingRequest();
             req.setId(containerToArray<kj::byte>(id));
-            return req.send().attach(kj::mv(client)).then(
+            return withDeadline(timer, node, req.send(), std::min(rpcDeadline(), deadline)).attach(kj::mv(client)).then(
                 [](capnp::Response<Peer::GetClosestPrecedingResults> &&res) {
                     return ClosestPrecedingPair{
                         nodeFromReader(res.getPreceding()),
@@ -496,12 +774,14 @@ void PeerImpl::getDataItemsOnJoinHelper(std::optional<NodeInformation::Node> suc
 {
     LOG_GET
     auto client = getClient(successorNode->getIp(), successorNode->getPort());
-    auto cap = client->getMain<Peer>();
+    auto cap = getPeer(*client, *successorNode);
     auto req = cap.getDataItemsOnJoinRequest();
     buildNode(req.getNewNode(), m_nodeInformation->getNode());
 
-    /* Start RPC */
-    req.send().then([LOG_CAPTURE, this](capnp::Response<Peer::GetDataItemsOnJoinResults> &&Response) {
+    /* Start RPC, it transfers data items and may take as long as a lookup. */
+    auto &timer = client->getIoProvider().getTimer();
+    auto deadline = clock_type::now() + std::chrono::milliseconds(m_conf.lookup_timeout);
+    withDeadline(timer, *successorNode, req.send(), deadline).then([LOG_CAPTURE, this](capnp::Response<Peer::GetDataItemsOnJoinResults> &&Response) {
         std::map<std::vector<uint8_t>, std::pair<std::vector<uint8_t>, uint16_t>> mapDataItemsToReturn;
 
         Response.getListOfDataItems().size();
@@ -518,7 +798,162 @@ void PeerImpl::getDataItemsOnJoinHelper(std::optional<NodeInformation::Node> suc
     }).wait(client->getWaitScope());
 }
 
+void PeerImpl::getMembersOnJoinHelper(const NodeInformation::Node &node)
+{
+    LOG_GET
+    if (!m_membership || node == m_nodeInformation->getNode())
+        return;
+    auto client = getClient(node.getIp(), node.getPort());
+    auto cap = getPeer(*client, node);
+    auto req = cap.getMembersRequest();
+    auto &timer = client->getIoProvider().getTimer();
+    withDeadline(timer, node, req.send(), rpcDeadline()).then([LOG_CAPTURE, this](
+        capnp::Response<Peer::GetMembersResults> &&response) {
+        auto members = membersFromReader(response.getMembers());
+        m_membership->merge(members);
+        LOG_DEBUG("got {} members on join", members.size());
+    }, [LOG_CAPTURE](const kj::Exception &e) {
+        // Gossip fills the membership in, just more slowly.
+        LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
+    }).wait(client->getWaitScope());
+}
+
 kj::Own<rpc::SecureRpcClient> PeerImpl::getClient(const std::string &ip, uint16_t port)
 {
     return rpc::getClient(m_conf, ip, port);
 }
+
+Peer::Client PeerImpl::getPeer(rpc::SecureRpcClient &client, const NodeInformation::Node &node)
+{
+    auto main = client.getMain<Peer>();
+    if (node.getVnode() == 0)
+        return main;
+    auto req = main.getVnodeRequest();
+    req.setIndex(node.getVnode());
+    return req.send().getPeer();
+}
+
+void PeerImpl::addVnode(kj::Own<PeerImpl> vnode)
+{
+    m_process->push_back(vnode.get());
+    vnode->m_process = m_process;
+    m_vnodes.emplace_back(kj::mv(vnode));
+}
+
+void PeerImpl::setOnMove(std::function<void()> onMove)
+{
+    m_onMove = std::move(onMove);
+}
+
+PeerImpl::clock_type::time_point PeerImpl::rpcDeadline() const
+{
+    return clock_type::now() + std::chrono::milliseconds(m_conf.rpc_timeout);
+}
+
+void PeerImpl::routeDirect(const NodeInformation::id_type &id, clock_type::time_point deadline,
+                           const NodeInformation::Node &origin, uint64_t lookup)
+{
+    LOG_GET
+    auto routing = m_nodeInformation->getRouting();
+    auto key = util::uint256(id);
+
+    const auto &pred = routing->predecessor;
+    if (pred && util::is_in_range_loop(key, pred->getKey(), routing->self, false, true)) {
+        deliverTo(origin, lookup, m_nodeInformation->getNode());
+        return;
+    }
+    const auto &successor = routing->successor;
+    if (successor && util::is_in_range_loop(key, routing->self, successor->getKey(), false, true)) {
+        deliverTo(origin, lookup, *successor);
+        return;
+    }
+
+    auto next = routing->closestPreceding(key);
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock_type::now()).count();
+    if (!next || remaining <= 0) {
+        deliverTo(origin, lookup, {});
+        return;
+    }
+
+    auto client = getClient(next->getIp(), next->getPort());
+    auto &timer = client->getIoProvider().getTimer();
+    auto cap = getPeer(*client, *next);
+    auto req = cap.findSuccessorDirectRequest();
+    req.setId(containerToArray<kj::byte>(id));
+    req.setBudget(static_cast<uint32_t>(std::min<int64_t>(remaining, std::numeric_limits<uint32_t>::max())));
+    buildNode(req.getOrigin(), origin);
+    req.setLookup(lookup);
+    // Only waits for the next hop to take over, not for the lookup.
+    withDeadline(timer, *next, req.send(), std::min(rpcDeadline(), deadline)).attach(kj::mv(client)).then(
+        [](capnp::Response<Peer::FindSuccessorDirectResults> &&) {},
+        [LOG_CAPTURE, this, origin, lookup](kj::Exception &&e) {
+            // Nobody else is going to answer origin.
+            LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
+            deliverTo(origin, lookup, {});
+        }
+    ).detach([LOG_CAPTURE](kj::Exception &&e) {
+        LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
+    });
+}
+
+void PeerImpl::deliverTo(const NodeInformation::Node &origin, uint64_t lookup,
+                         const std::optional<NodeInformation::Node> &successor)
+{
+    LOG_GET
+    if (origin == m_nodeInformation->getNode()) {
+        resolveLookup(lookup, successor);
+        return;
+    }
+
+    auto client = getClient(origin.getIp(), origin.getPort());
+    auto &timer = client->getIoProvider().getTimer();
+    auto cap = getPeer(*client, origin);
+    auto req = cap.deliverRequest();
+    req.setLookup(lookup);
+    buildNode(req.getNode(), successor);
+    withDeadline(timer, origin, req.send(), rpcDeadline()).attach(kj::mv(client)).ignoreResult().detach(
+        [LOG_CAPTURE](kj::Exception &&e) {
+            LOG_DEBUG("Exception in request\n\t\t{}", e.getDescription().cStr());
+        });
+}
+
+void PeerImpl::resolveLookup(uint64_t lookup, const std::optional<NodeInformation::Node> &successor)
+{
+    auto it = m_pendingLookups.find(lookup);
+    if (it == m_pendingLookups.end()) {
+        SPDLOG_DEBUG("result of unknown lookup {}", lookup);
+        return;
+    }
+    it->second->fulfill(std::optional<NodeInformation::Node>{successor});
+    m_pendingLookups.erase(it);
+}
+
+PeerImpl::VerificationStats PeerImpl::getVerificationStats() const
+{
+    return {m_verificationsPerformed, m_verificationsFailed, m_verificationsSkipped};
+}
+
+bool PeerImpl::needsVerification(bool finalHop)
+{
+    switch (m_verificationPolicy) {
+        case VerificationPolicy::ALWAYS:
+            return true;
+        case VerificationPolicy::SAMPLED:
+            return finalHop && m_verificationSample(m_random);
+        case VerificationPolicy::NEVER:
+            return false;
+        default:
+            return finalHop;
+    }
+}
+
+void PeerImpl::recordFailure(const NodeInformation::Node &peer)
+{
+    if (m_failureDetector->failure(peer)) {
+        SPDLOG_INFO("{}:{} did not answer {} RPCs in a row, removing it from the routing table",
+                    peer.getIp(), peer.getPort(), m_conf.peer_dead_after);
+        m_nodeInformation->removePeer(peer);
+        if (m_membership)
+            m_membership->dead(peer);
+    }
+}
@@ -6,8 +6,18 @@
 #include <peer.capnp.h>
 #include <memory>
 #include <unordered_set>
+#include <unordered_map>
+#include <random>
 #include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include <functional>
+#include <kj/timer.h>
 #include "NodeInformation.h"
+#include "FailureDetector.h"
+#include "Membership.h"
+#include "LoadBalancer.h"
 
 namespace dht
 {
@@ -61,6 +71,38 @@ namespace dht
         ::kj::Promise<void> sendPoWPuzzleResponseToBootstrapAndGetSuccessor(
             SendPoWPuzzleResponseToBootstrapAndGetSuccessorContext context) override;
 
+        /**
+         * @brief Takes over a lookup in DIRECT mode. Returns before the lookup is resolved.
+         */
+        ::kj::Promise<void> findSuccessorDirect(FindSuccessorDirectContext context) override;
+
+        /**
+         * @brief Receives the result of a lookup this node started in DIRECT mode.
+         */
+        ::kj::Promise<void> deliver(DeliverContext context) override;
+
+        /**
+         * @brief Returns every member this node knows of, for a node that joins with full_membership.
+         */
+        ::kj::Promise<void> getMembers(GetMembersContext context) override;
+
+        /**
+         * @brief Returns the capability of another vnode of this process.
+         */
+        ::kj::Promise<void> getVnode(GetVnodeContext context) override;
+
+        /**
+         * @brief Returns the load of this node, for a successor that decides whether to rebalance.
+         */
+        ::kj::Promise<void> getLoad(GetLoadContext context) override;
+
+        /**
+         * @brief
+         * Moves this node forward into the arc of its successor, if it is a vnode other than 0 and has a free index
+         * whose id lies before the split. The items up to the new position are taken over like on join.
+         */
+        ::kj::Promise<void> takeOver(TakeOverContext context) override;
+
         struct ClosestPrecedingPair
         {
             std::optional<NodeInformation::Node> closestPreceding{};
@@ -75,43 +117,222 @@ namespace dht
          */
         ::kj::Promise<ClosestPrecedingPair>
         getClosestPrecedingHelper(const NodeInformation::Node &node, const NodeInformation::id_type &id,
-                                  const std::shared_ptr<std::unordered_set<NodeInformation::Node, NodeInformation::Node::Node_hash>> &distrusted);
+                                  const std::shared_ptr<std::unordered_set<NodeInformation::Node, NodeInformation::Node::Node_hash>> &distrusted,
+                                  std::chrono::steady_clock::time_point deadline);
 
     public:
+        using clock_type = std::chrono::steady_clock;
+
         enum class GetSuccessorMethod
         {
-            PASS_ON, LOCAL
+            /// Recursive, every hop waits for the next one and relays the answer back.
+            PASS_ON,
+            /// Iterative, this node asks every hop itself and verifies the answers.
+            LOCAL,
+            /// Recursive, the responsible node answers this node directly.
+            DIRECT
         };
 
-        explicit PeerImpl(std::shared_ptr<NodeInformation>, config::Configuration conf, GetSuccessorMethod = GetSuccessorMethod::LOCAL);
+        /**
+         * @brief Which direct successors returned by a hop of a LOCAL lookup are checked with an extra RPC.
+         */
+        enum class VerificationPolicy
+        {
+            /// Every returned direct successor, also those of hops that are not the last.
+            ALWAYS,
+            /// Only the successor of the last hop, i.e. the result, with a configurable probability.
+            SAMPLED,
+            /// Only the successor of the last hop, i.e. the result.
+            FINAL_HOP,
+            /// None, for networks in which all peers are trusted.
+            NEVER
+        };
+
+        struct VerificationStats
+        {
+            uint64_t performed;
+            /// Successors that were not responsible for the id or did not answer.
+            uint64_t failed;
+            uint64_t skipped;
+        };
+
+        explicit PeerImpl(std::shared_ptr<NodeInformation>, config::Configuration conf,
+                          std::shared_ptr<FailureDetector> failureDetector,
+                          std::shared_ptr<Membership> membership = {},
+                          GetSuccessorMethod = GetSuccessorMethod::LOCAL);
 
         static NodeInformation::Node nodeFromReader(Node::Reader node);
         static std::optional<NodeInformation::Node> nodeFromReader(Optional<Node>::Reader node);
         static void buildNode(Node::Builder builder, const NodeInformation::Node &node);
         static void buildNode(Optional<Node>::Builder builder, const std::optional<NodeInformation::Node> &node);
+        static void buildNode(Optional<Node>::Builder builder, const NodeInformation::node_handle &node);
         static NodeInformation::id_type idFromReader(capnp::Data::Reader id);
+        static std::vector<Membership::Member> membersFromReader(capnp::List<Member>::Reader members);
+        static void buildMembers(capnp::List<Member>::Builder builder, const std::vector<Membership::Member> &members);
         template<typename T, typename Cont>
         inline static kj::Array<T> containerToArray(const Cont &cont)
         {
             return kj::heapArray<T>(cont.begin(), cont.end());
         }
 
+        /**
+         * @brief Looks up the successor of id within the lookup timeout.
+         */
         ::kj::Promise<std::optional<NodeInformation::Node>> getSuccessor(NodeInformation::id_type id);
+        /**
+         * @brief Looks up the successor of id. Every hop is bounded by the RPC timeout and the remaining time.
+         */
+        ::kj::Promise<std::optional<NodeInformation::Node>>
+        getSuccessor(NodeInformation::id_type id, clock_type::time_point deadline);
         std::optional<NodeInformation::Node> getClosestPreceding(NodeInformation::id_type id);
 
         std::optional<std::vector<uint8_t>> getData(const NodeInformation::Node &node, const std::vector<uint8_t> &key);
-        void setData(const NodeInformation::Node &node,
+        /**
+         * @return The value of key on node and when it expires there
+         */
+        std::optional<NodeInformation::data_type::mapped_type>
+        getDataExpires(const NodeInformation::Node &node, const std::vector<uint8_t> &key);
+        /**
+         * @return Whether node stored the value
+         */
+        bool setData(const NodeInformation::Node &node,
                      const std::vector<uint8_t> &key, const std::vector<uint8_t> &value,
                      uint16_t ttl);
 
         void getDataItemsOnJoinHelper(std::optional<NodeInformation::Node> successorNode);
+        /**
+         * @brief Copies the membership of node, which this node just joined next to.
+         */
+        void getMembersOnJoinHelper(const NodeInformation::Node &node);
 
         kj::Own<rpc::SecureRpcClient> getClient(const std::string &ip, uint16_t port);
+        /**
+         * @brief
+         * The capability of node, on the process client is connected to. Vnodes other than 0 are reached through
+         * getVnode, which is pipelined and costs no extra round trip.
+         */
+        static Peer::Client getPeer(rpc::SecureRpcClient &client, const NodeInformation::Node &node);
+
+        /**
+         * @brief Serves vnode through getVnode. Only called before the server runs, on the server's thread.
+         */
+        void addVnode(kj::Own<PeerImpl> vnode);
+
+        /**
+         * @brief Called on the server's thread after this node moved to another position for load balancing.
+         */
+        void setOnMove(std::function<void()> onMove);
+
+        /**
+         * @return Bytes stored in the arc of this node, or data requests in the last rebalance_interval, by load_metric
+         */
+        [[nodiscard]] uint64_t load();
+
+        /**
+         * @return Deadline of an RPC sent now
+         */
+        [[nodiscard]] clock_type::time_point rpcDeadline() const;
+
+        /**
+         * @brief
+         * Fails with a kj::Exception if promise does not resolve before deadline, and counts the timeout for peer.
+         * The promise is cancelled, so a peer that does not answer does not hold the caller until TCP gives up.
+         * The outcome is reported to the failure detector. Only a lost connection or a missing answer counts as a
+         * failure, an exception thrown by the peer's handler means the peer is alive.
+         * @param timer Timer of the event loop the promise runs on, e.g. the client's
+         */
+        template<typename T>
+        kj::Promise<T> withDeadline(kj::Timer &timer, const NodeInformation::Node &peer, kj::Promise<T> promise,
+                                    clock_type::time_point deadline)
+        {
+            auto start = clock_type::now();
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - start);
+            auto bounded = promise.exclusiveJoin(
+                timer.afterDelay(std::max<int64_t>(0, remaining.count()) * kj::MILLISECONDS).then(
+                    [nodeInformation = m_nodeInformation, peer]() -> kj::Promise<T> {
+                        nodeInformation->countTimeout(peer);
+                        return KJ_EXCEPTION(OVERLOADED, "RPC deadline exceeded", peer.getIp().c_str(), peer.getPort());
+                    }));
+            auto onFailure = [this, peer](kj::Exception &&e) -> kj::Promise<T> {
+                if (e.getType() == kj::Exception::Type::DISCONNECTED || e.getType() == kj::Exception::Type::OVERLOADED)
+                    recordFailure(peer);
+                return kj::mv(e);
+            };
+            if constexpr (std::is_void_v<T>) {
+                return bounded.then([failureDetector = m_failureDetector, peer, start]() -> kj::Promise<void> {
+                    failureDetector->success(peer, clock_type::now() - start);
+                    return kj::READY_NOW;
+                }, kj::mv(onFailure));
+            } else {
+                return bounded.then([failureDetector = m_failureDetector, peer, start](T &&result) -> kj::Promise<T> {
+                    failureDetector->success(peer, clock_type::now() - start);
+                    return kj::mv(result);
+                }, kj::mv(onFailure));
+            }
+        }
+
+        [[nodiscard]] FailureDetector &getFailureDetector() { return *m_failureDetector; }
+        /**
+         * @return The membership, nullptr without full_membership
+         */
+        [[nodiscard]] const std::shared_ptr<Membership> &getMembership() const { return m_membership; }
+
+        [[nodiscard]] VerificationStats getVerificationStats() const;
 
     private:
+        /**
+         * @brief Reports a failed RPC, and removes peer from the routing state once it is considered dead.
+         */
+        void recordFailure(const NodeInformation::Node &peer);
+
+        /**
+         * @brief
+         * Answers lookup to origin if this node knows the successor of id. Otherwise forwards the lookup to the
+         * closest preceding finger, without waiting for the result.
+         */
+        void routeDirect(const NodeInformation::id_type &id, clock_type::time_point deadline,
+                         const NodeInformation::Node &origin, uint64_t lookup);
+        /**
+         * @brief Sends the result of lookup to origin, or resolves it if this node is origin.
+         */
+        void deliverTo(const NodeInformation::Node &origin, uint64_t lookup,
+                       const std::optional<NodeInformation::Node> &successor);
+        void resolveLookup(uint64_t lookup, const std::optional<NodeInformation::Node> &successor);
+
+        /**
+         * @param finalHop Whether the hop returned no closer node, so that its successor is the result
+         */
+        bool needsVerification(bool finalHop);
+
         GetSuccessorMethod m_getSuccessorMethod;
         std::shared_ptr<NodeInformation> m_nodeInformation;
         const config::Configuration m_conf;
+        std::shared_ptr<FailureDetector> m_failureDetector;
+        /// Shared with the Dht, nullptr without full_membership.
+        std::shared_ptr<Membership> m_membership;
+        /// The other vnodes of this process, which this one serves. Only used on the server's thread.
+        std::vector<Peer::Client> m_vnodes{};
+        /// Every PeerImpl of this process, shared by all of them. A vnode can change its index, so getVnode looks
+        /// them up by their current node. Only used on the server's thread.
+        std::shared_ptr<std::vector<PeerImpl *>> m_process;
+        /// Data requests this node served, for load_metric requests.
+        RequestRate m_requests;
+        /// When this node last moved for load balancing. Only used on the server's thread.
+        std::optional<clock_type::time_point> m_lastMove{};
+        std::function<void()> m_onMove{};
+
+        /// Lookups started by this node in DIRECT mode, waiting for deliver. Only used on the server's thread.
+        std::unordered_map<uint64_t, kj::Own<kj::PromiseFulfiller<std::optional<NodeInformation::Node>>>>
+            m_pendingLookups{};
+        /// Lookup ids are random, so a stale or forged deliver is unlikely to match a pending lookup.
+        /// Also samples verifications. Only used on the server's thread.
+        std::mt19937_64 m_random{std::random_device{}()};
+
+        const VerificationPolicy m_verificationPolicy;
+        std::bernoulli_distribution m_verificationSample;
+        std::atomic<uint64_t> m_verificationsPerformed{0};
+        std::atomic<uint64_t> m_verificationsFailed{0};
+        std::atomic<uint64_t> m_verificationsSkipped{0};
     };
 }
 
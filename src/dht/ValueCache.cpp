@@ -0,0 +1,74 @@
+#include "ValueCache.h"
+
+using dht::ValueCache;
+
+ValueCache::ValueCache(Options options) :
+    m_options(options)
+{
+}
+
+std::optional<ValueCache::value_type> ValueCache::find(const key_type &key)
+{
+    std::scoped_lock lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it->second.expires <= clock_type::now()) {
+        erase(it);
+        it = m_entries.end();
+    }
+    if (it == m_entries.end()) {
+        ++m_stats.misses;
+        return {};
+    }
+    ++m_stats.hits;
+    m_used.splice(m_used.begin(), m_used, it->second.used);
+    return it->second.value;
+}
+
+void ValueCache::insert(const key_type &key, const value_type &value, clock_type::time_point expires)
+{
+    if (m_options.capacity == 0)
+        return;
+
+    auto now = clock_type::now();
+    // expires may be time_point::max(), do not add to it.
+    if (expires - now > m_options.max_staleness)
+        expires = now + std::chrono::duration_cast<clock_type::duration>(m_options.max_staleness);
+    if (expires <= now)
+        return;
+
+    std::scoped_lock lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->second.value = value;
+        it->second.expires = expires;
+        m_used.splice(m_used.begin(), m_used, it->second.used);
+        return;
+    }
+
+    if (m_entries.size() >= m_options.capacity)
+        erase(m_entries.find(m_used.back()));
+    m_used.push_front(key);
+    m_entries.emplace(key, Entry{value, expires, m_used.begin()});
+}
+
+void ValueCache::erase(const key_type &key)
+{
+    std::scoped_lock lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end())
+        erase(it);
+}
+
+ValueCache::Stats ValueCache::stats() const
+{
+    std::scoped_lock lock(m_mutex);
+    auto stats = m_stats;
+    stats.size = m_entries.size();
+    return stats;
+}
+
+void ValueCache::erase(entries_type::iterator it)
+{
+    m_used.erase(it->second.used);
+    m_entries.erase(it);
+}
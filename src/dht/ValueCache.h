@@ -0,0 +1,88 @@
+#ifndef DHT_VALUECACHE_H
+#define DHT_VALUECACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace dht
+{
+    /**
+     * @brief
+     * Values of recently read keys, so that reads of hot keys are answered by the node that serves the api instead of
+     * the responsible node.
+     *
+     * A value is served until it expires on the responsible node, but at most for `max_staleness` after it was
+     * fetched: writes through other nodes are seen after max_staleness at the latest. Least recently used values are
+     * evicted first.
+     *
+     * Thread-safe.
+     */
+    class ValueCache
+    {
+    public:
+        using clock_type = std::chrono::system_clock;
+        using key_type = std::vector<uint8_t>;
+        using value_type = std::vector<uint8_t>;
+
+        struct Options
+        {
+            /// Maximum number of values, 0 disables the cache.
+            size_t capacity{0};
+            std::chrono::milliseconds max_staleness{1000};
+        };
+
+        struct Stats
+        {
+            uint64_t hits{0};
+            uint64_t misses{0};
+            size_t size{0};
+        };
+
+        explicit ValueCache(Options options);
+
+        /**
+         * @return The value of key, if it was fetched within max_staleness and did not expire
+         */
+        std::optional<value_type> find(const key_type &key);
+
+        /**
+         * @brief Remembers value of key, fetched just now, which expires at expires.
+         */
+        void insert(const key_type &key, const value_type &value, clock_type::time_point expires);
+
+        /**
+         * @brief Forgets the value of key, e.g. because it was written through this node.
+         */
+        void erase(const key_type &key);
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        struct Entry
+        {
+            value_type value;
+            clock_type::time_point expires;
+            std::list<key_type>::iterator used;
+        };
+
+        using entries_type = std::map<key_type, Entry>;
+
+        void erase(entries_type::iterator it);
+
+        const Options m_options;
+
+        mutable std::mutex m_mutex{};
+        entries_type m_entries{};
+        /// Keys, most recently used first.
+        std::list<key_type> m_used{};
+        Stats m_stats{};
+    };
+}
+
+#endif //DHT_VALUECACHE_H
@@ -25,6 +25,8 @@ namespace entry
 
     std::string format_node(const NodeInformation::Node &node)
     {
+        if (node.getVnode() != 0)
+            return fmt::format("{}:{:>04}#{}", node.getIp(), node.getPort(), node.getVnode());
         return fmt::format("{}:{:>04}", node.getIp(), node.getPort());
     }
 
@@ -81,6 +83,9 @@ Entry::Entry(const config::Configuration &conf) : Entry()
 
             m_DHTs[i]->setApi(std::make_unique<api::Api>(api::Options{
                 .port= api_port,
+                .threads= m_conf.api_threads,
+                .max_connections= m_conf.api_max_connections,
+                .idle_timeout= std::chrono::seconds(m_conf.api_idle_timeout),
             }));
 
             ++dht_port;
@@ -231,6 +236,9 @@ void Entry::addNode(std::optional<uint16_t> portParam, std::ostream &os)
 
     m_DHTs.back()->setApi(std::make_unique<api::Api>(api::Options{
         .port= static_cast<uint16_t>(m_nodes.back()->getPort() + static_cast<uint16_t>(1000)),
+        .threads= m_conf.api_threads,
+        .max_connections= m_conf.api_max_connections,
+        .idle_timeout= std::chrono::seconds(m_conf.api_idle_timeout),
     }));
 
     os
@@ -399,7 +407,7 @@ Entry::Entry() : m_commands{
         {
             .brief= "Show data depending on arguments",
             .usage= "show <WHAT> [ARGS...]\n\n" +
-                    format_argument_choice("WHAT", {"nodes", "data", "fingers"}),
+                    format_argument_choice("WHAT", {"nodes", "data", "fingers", "timeouts", "peers", "verification", "cache", "members"}),
             .execute=
             [this](const std::vector<std::string> &args, std::ostream &os, std::ostream &err) {
                 if (args.empty())
@@ -438,21 +446,31 @@ Entry::Entry() : m_commands{
                     if (index >= m_nodes.size())
                         throw std::invalid_argument("Index [" + util::to_string(*index) + "] out of bounds!");
                     auto &node = *m_nodes[*index];
+                    std::vector<std::string> successors{};
+                    for (const auto &successor: node.getSuccessorList())
+                        successors.push_back(format_node(successor));
+                    std::vector<std::string> vnodes{};
+                    for (const auto &vnode: m_DHTs[*index]->getVnodes())
+                        vnodes.push_back(format_node(vnode->getNode()) + " -> " + format_node(vnode->getSuccessor()));
 
                     os << fmt::format(
                         ""
                         "nodes[{:>03}]    : {}"            "\n"
                         "  id          : {}"               "\n"
                         "  successor   : {}"               "\n"
+                        "  successors  : [{}]"             "\n"
                         "  predecessor : {}"               "\n"
                         "  bootstrap   : {}"               "\n"
+                        "  vnodes      : [{}]"             "\n"
                         /* == == == == */,
                         *index,
                         format_node(node.getNode()),
                         util::hexdump(node.getId(), 32, false, false),
                         format_node(node.getSuccessor()),
+                        fmt::join(successors, ", "),
                         format_node(node.getPredecessor()),
-                        format_node(node.getBootstrapNode())
+                        format_node(node.getBootstrapNode()),
+                        fmt::join(vnodes, ", ")
                     ) << std::endl;
                 } else {
                     for (size_t i = 0; i < m_nodes.size(); ++i) {
@@ -510,7 +528,7 @@ Entry::Entry() : m_commands{
     {
         "show:fingers",
         {
-            .brief= "Show finger table of a node",
+            .brief= "Show finger table of a node and how fresh it is",
             .usage= "show fingers <INDEX>",
             .execute=
             [this](const std::vector<std::string> &args, std::ostream &os, std::ostream &) {
@@ -546,6 +564,172 @@ Entry::Entry() : m_commands{
                     }
                     last_finger = finger;
                 }
+                auto routing = node.getRouting();
+                for (size_t i = 0; i < routing->digitFingers.size(); ++i) {
+                    const auto &finger = routing->digitFingers[i];
+                    if (i == 0 || finger != routing->digitFingers[i - 1])
+                        os << fmt::format("[d{:>03}] : {}", i, finger ? format_node(*finger) : "<null>") << std::endl;
+                }
+                for (const auto &learned: routing->learned)
+                    os << fmt::format("[learned] : {}", format_node(*learned)) << std::endl;
+
+                auto stats = m_DHTs[*index]->getFingerStats();
+                os << fmt::format(
+                    ""
+                    "rounds      : {}"                      "\n"
+                    "last round  : {} lookups, {} changed"  "\n"
+                    "staleness   : oldest {}ms, mean {}ms"  "\n"
+                    "interval    : {}ms"                    "\n"
+                    /* == == == == */,
+                    stats.rounds,
+                    stats.lookups_last_round, stats.changed_last_round,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(stats.oldest).count(),
+                    std::chrono::duration_cast<std::chrono::milliseconds>(stats.mean).count(),
+                    stats.interval.count()
+                );
+            }
+        }
+    },
+    {
+        "show:timeouts",
+        {
+            .brief= "Show the peers whose RPCs ran into their deadline",
+            .usage= "show timeouts <INDEX>",
+            .execute=
+            [this](const std::vector<std::string> &args, std::ostream &os, std::ostream &) {
+                std::optional<uint32_t> index{};
+                if (!args.empty())
+                    index = parse_number(args[0]);
+                if (!index)
+                    throw std::invalid_argument("INDEX required!");
+                if (index >= m_nodes.size())
+                    throw std::invalid_argument(fmt::format("Index [{}] out of bounds!", *index));
+
+                auto timeouts = m_nodes[*index]->getTimeouts();
+                if (timeouts.empty())
+                    os << "No timeouts" << std::endl;
+                for (const auto &[peer, count]: timeouts)
+                    os << fmt::format("{} : {}", format_node(peer), count) << std::endl;
+            }
+        }
+    },
+    {
+        "show:peers",
+        {
+            .brief= "Show the liveness of the peers a node talked to",
+            .usage= "show peers <INDEX>",
+            .execute=
+            [this](const std::vector<std::string> &args, std::ostream &os, std::ostream &) {
+                std::optional<uint32_t> index{};
+                if (!args.empty())
+                    index = parse_number(args[0]);
+                if (!index)
+                    throw std::invalid_argument("INDEX required!");
+                if (index >= m_nodes.size())
+                    throw std::invalid_argument(fmt::format("Index [{}] out of bounds!", *index));
+
+                for (const auto &stats: m_DHTs[*index]->getPeerStats()) {
+                    os << fmt::format(
+                        "{} : {:<8} rtt {:>8} failures {} last seen {}ms ago",
+                        format_node(stats.peer),
+                        dht::FailureDetector::to_string(stats.verdict),
+                        stats.rtt ? fmt::format("{}us", stats.rtt->count()) : std::string("-"),
+                        stats.failures,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(stats.since).count()
+                    ) << std::endl;
+                }
+            }
+        }
+    },
+    {
+        "show:members",
+        {
+            .brief= "Show the ring membership a node knows of, with full_membership",
+            .usage= "show members <INDEX>",
+            .execute=
+            [this](const std::vector<std::string> &args, std::ostream &os, std::ostream &) {
+                std::optional<uint32_t> index{};
+                if (!args.empty())
+                    index = parse_number(args[0]);
+                if (!index)
+                    throw std::invalid_argument("INDEX required!");
+                if (index >= m_nodes.size())
+                    throw std::invalid_argument(fmt::format("Index [{}] out of bounds!", *index));
+
+                for (const auto &member: m_DHTs[*index]->getMembers()) {
+                    os << fmt::format(
+                        "{} : {:<5} incarnation {}",
+                        format_node(member.node), member.alive ? "alive" : "dead", member.incarnation
+                    ) << std::endl;
+                }
+            }
+        }
+    },
+    {
+        "show:verification",
+        {
+            .brief= "Show how many successors returned by lookups a node verified",
+            .usage= "show verification <INDEX>",
+            .execute=
+            [this](const std::vector<std::string> &args, std::ostream &os, std::ostream &) {
+                std::optional<uint32_t> index{};
+                if (!args.empty())
+                    index = parse_number(args[0]);
+                if (!index)
+                    throw std::invalid_argument("INDEX required!");
+                if (index >= m_nodes.size())
+                    throw std::invalid_argument(fmt::format("Index [{}] out of bounds!", *index));
+
+                auto stats = m_DHTs[*index]->getVerificationStats();
+                os << fmt::format(
+                    ""
+                    "performed : {}"  "\n"
+                    "failed    : {}"  "\n"
+                    "skipped   : {}"  "\n"
+                    /* == == == == */,
+                    stats.performed, stats.failed, stats.skipped
+                );
+            }
+        }
+    },
+    {
+        "show:cache",
+        {
+            .brief= "Show how many lookups and reads of a node were answered by its lookup and value caches",
+            .usage= "show cache <INDEX>",
+            .execute=
+            [this](const std::vector<std::string> &args, std::ostream &os, std::ostream &) {
+                std::optional<uint32_t> index{};
+                if (!args.empty())
+                    index = parse_number(args[0]);
+                if (!index)
+                    throw std::invalid_argument("INDEX required!");
+                if (index >= m_nodes.size())
+                    throw std::invalid_argument(fmt::format("Index [{}] out of bounds!", *index));
+
+                auto hitRate = [](uint64_t hits, uint64_t misses) {
+                    return hits + misses > 0 ? 100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses)
+                                             : 0.0;
+                };
+                auto stats = m_DHTs[*index]->getLookupCacheStats();
+                auto values = m_DHTs[*index]->getValueCacheStats();
+                os << fmt::format(
+                    ""
+                    "lookups"                 "\n"
+                    "entries       : {}"      "\n"
+                    "hits          : {}"      "\n"
+                    "misses        : {}"      "\n"
+                    "hit rate      : {:.1f}%" "\n"
+                    "invalidations : {}"      "\n"
+                    "values"                  "\n"
+                    "entries       : {}"      "\n"
+                    "hits          : {}"      "\n"
+                    "misses        : {}"      "\n"
+                    "hit rate      : {:.1f}%" "\n"
+                    /* == == == == */,
+                    stats.size, stats.hits, stats.misses, hitRate(stats.hits, stats.misses), stats.invalidations,
+                    values.size, values.hits, values.misses, hitRate(values.hits, values.misses)
+                );
             }
         }
     }
@@ -16,6 +16,8 @@
 #include <bitset>
 #include <openssl/sha.h>
 #include <array>
+#include <compare>
+#include <bit>
 
 namespace util
 {
@@ -120,6 +122,109 @@ namespace util
         return ret;
     }
 
+    /**
+     * @brief
+     * Unsigned 256 bit integer for arithmetic on ring ids, stored as four 64 bit words, most significant first.
+     * Ids are transferred and stored as 32 big-endian bytes, converting once allows comparing and adding
+     * them a word instead of a byte at a time.
+     */
+    struct uint256
+    {
+        static constexpr size_t word_count = 4;
+        static constexpr size_t byte_count = word_count * sizeof(uint64_t);
+
+        std::array<uint64_t, word_count> words{};
+
+        constexpr uint256() = default;
+
+        constexpr explicit uint256(const std::array<uint8_t, byte_count> &bytes)
+        {
+            for (size_t w = 0; w < word_count; ++w) {
+                uint64_t word = 0;
+                for (size_t i = 0; i < sizeof(uint64_t); ++i)
+                    word = (word << 8) | bytes[w * sizeof(uint64_t) + i];
+                words[w] = word;
+            }
+        }
+
+        /**
+         * @return 2^exp, or 0 if exp >= 256
+         */
+        static constexpr uint256 pow2(size_t exp)
+        {
+            uint256 ret{};
+            if (exp < word_count * 64)
+                ret.words[word_count - 1 - exp / 64] = uint64_t{1} << (exp % 64);
+            return ret;
+        }
+
+        [[nodiscard]] constexpr std::array<uint8_t, byte_count> bytes() const
+        {
+            std::array<uint8_t, byte_count> ret{};
+            for (size_t w = 0; w < word_count; ++w)
+                for (size_t i = 0; i < sizeof(uint64_t); ++i)
+                    ret[w * sizeof(uint64_t) + i] = static_cast<uint8_t>(words[w] >> (8 * (sizeof(uint64_t) - 1 - i)));
+            return ret;
+        }
+
+        [[nodiscard]] constexpr bool is_zero() const
+        {
+            return (words[0] | words[1] | words[2] | words[3]) == 0;
+        }
+
+        /**
+         * @return Number of bits needed to represent the value, 0 for zero. Like std::bit_width.
+         */
+        [[nodiscard]] constexpr size_t bit_width() const
+        {
+            for (size_t w = 0; w < word_count; ++w)
+                if (words[w] != 0)
+                    return (word_count - 1 - w) * 64 + static_cast<size_t>(std::bit_width(words[w]));
+            return 0;
+        }
+
+        friend constexpr bool operator==(const uint256 &a, const uint256 &b)
+        {
+            // Without branches, so that the compiler can compare all words at once.
+            return ((a.words[0] ^ b.words[0]) | (a.words[1] ^ b.words[1]) |
+                    (a.words[2] ^ b.words[2]) | (a.words[3] ^ b.words[3])) == 0;
+        }
+
+        friend constexpr std::strong_ordering operator<=>(const uint256 &a, const uint256 &b)
+        {
+            for (size_t w = 0; w < word_count; ++w)
+                if (a.words[w] != b.words[w])
+                    return a.words[w] <=> b.words[w];
+            return std::strong_ordering::equal;
+        }
+
+        /// Addition modulo 2^256.
+        friend constexpr uint256 operator+(const uint256 &a, const uint256 &b)
+        {
+            uint256 ret{};
+            uint64_t carry = 0;
+            for (size_t w = word_count; w-- > 0;) {
+                uint64_t sum = a.words[w] + carry;
+                carry = sum < carry ? 1 : 0;
+                ret.words[w] = sum + b.words[w];
+                carry += ret.words[w] < sum ? 1 : 0;
+            }
+            return ret;
+        }
+
+        /// Subtraction modulo 2^256, i.e. the clockwise distance from b to a on the ring.
+        friend constexpr uint256 operator-(const uint256 &a, const uint256 &b)
+        {
+            uint256 ret{};
+            uint64_t borrow = 0;
+            for (size_t w = word_count; w-- > 0;) {
+                ret.words[w] = a.words[w] - b.words[w] - borrow;
+                borrow = (a.words[w] < b.words[w] || (a.words[w] == b.words[w] && borrow)) ? 1 : 0;
+            }
+            return ret;
+        }
+    };
+
     template<typename Char>
     inline auto to_lower(const std::basic_string<Char> &str)
     {
@@ -287,4 +392,21 @@ constexpr auto operator+(const std::array<T, size> &a, const std::array<T, size>
     return ret;
 }
 
+/**
+ * @brief Subtraction modulo 2^(bits of the array), i.e. the clockwise distance from b to a on the ring.
+ */
+template<typename T, size_t size, std::enable_if_t<std::is_unsigned_v<T>, int> = 0>
+constexpr auto operator-(const std::array<T, size> &a, const std::array<T, size> &b)
+{
+    std::array<T, size> ret;
+    bool borrow = false;
+    for (int i = size - 1; i >= 0; --i) {
+        T subtrahend = b[i];
+        bool next_borrow = a[i] < subtrahend || (a[i] == subtrahend && borrow);
+        ret[i] = static_cast<T>(a[i] - subtrahend - (borrow ? 1 : 0));
+        borrow = next_borrow;
+    }
+    return ret;
+}
+
 #endif //DHT_UTIL_H
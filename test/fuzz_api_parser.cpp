@@ -0,0 +1,50 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <span>
+#include <algorithm>
+#include <request.h>
+#include <parser.h>
+#include <constants.h>
+
+/*
+ * libFuzzer entry point for the api wire format. Build with -DDHT_BUILD_FUZZERS=ON using clang, then run e.g.
+ *   ./fuzz_api_parser -dict=test/fuzz_api_parser.dict -max_len=70000
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::span<const uint8_t> bytes(data, size);
+    api::parser::Frame frame{};
+    if (api::parser::parse(bytes, frame) != api::parser::Status::OK)
+        return 0;
+
+    switch (frame.header.msg_type) {
+        // Responses are never received by the server, but a client decodes them.
+        case util::constants::DHT_SUCCESS: {
+            api::Message_DHT_SUCCESS success(frame);
+            if (!std::ranges::equal(success.key, frame.key) || !std::ranges::equal(success.value, frame.value))
+                std::abort();
+            return 0;
+        }
+        case util::constants::DHT_FAILURE: {
+            api::Message_KEY failure(frame);
+            if (!std::ranges::equal(failure.key, frame.key))
+                std::abort();
+            return 0;
+        }
+        default:
+            break;
+    }
+
+    // Whatever else the parser accepts must decode into a request, with the same key and value.
+    api::Request request(frame);
+    auto *message = request.getData();
+    if (!message || message->m_header.size != size || message->m_header.msg_type != frame.header.msg_type)
+        std::abort();
+    if (auto *put = request.getData<api::Message_DHT_PUT>()) {
+        if (!std::ranges::equal(put->key, frame.key) || !std::ranges::equal(put->value, frame.value))
+            std::abort();
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef DHT_NODES_H
+#define DHT_NODES_H
+
+#include <cstdint>
+#include <NodeInformation.h>
+
+/**
+ * @return Id whose first byte is first and all others 0
+ */
+inline NodeInformation::id_type id(uint8_t first)
+{
+    NodeInformation::id_type id{};
+    id[0] = first;
+    return id;
+}
+
+inline NodeInformation::Node node(uint8_t first, uint16_t port)
+{
+    return NodeInformation::Node{"127.0.0.1", port, id(first)};
+}
+
+#endif //DHT_NODES_H
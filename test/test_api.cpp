@@ -2,6 +2,7 @@
 #include <cstdint>
 #include "assertions.h"
 #include <api.h>
+#include <parser.h>
 #include <util.h>
 #include <constants.h>
 
@@ -23,9 +24,10 @@ int main()
 
             auto bytes = util::convertToBytes(byteString);
 
-            api::MessageHeader header(reinterpret_cast<const api::MessageHeader::MessageHeaderRaw &>(bytes.front()));
+            api::parser::Frame frame{};
+            assert_true(api::parser::parse(bytes, frame) == api::parser::Status::OK);
 
-            api::Request request(header, bytes);
+            api::Request request(frame);
 
             auto *request_data = request.getData<api::Message_KEY>();
             assert_null(request.getData<api::Message_DHT_PUT>());
@@ -55,9 +57,10 @@ int main()
 
             auto bytes = util::convertToBytes(byteString);
 
-            api::MessageHeader header(reinterpret_cast<const api::MessageHeader::MessageHeaderRaw &>(bytes.front()));
+            api::parser::Frame frame{};
+            assert_true(api::parser::parse(bytes, frame) == api::parser::Status::OK);
 
-            api::Request request(header, bytes);
+            api::Request request(frame);
 
             auto *request_data = request.getData<api::Message_DHT_PUT>();
             assert_null(request.getData<api::Message_KEY>());
@@ -128,6 +131,62 @@ int main()
             std::cout << "Message:" << std::endl;
             util::hexdump(message.m_bytes, 16);
 
+            return 0;
+        }) ||
+        run_test("API ENCODE SUCCESS SEGMENTS", []() {
+            std::string sKey =
+                "\x01\x02\x03\x04"s  // key
+                "\x05\x06\x07\x08"s  // key
+                "\x09\x0a\x0b\x0c"s  // key
+                "\x0d\x0e\x0f\x10"s  // key
+                "\x11\x12\x13\x14"s  // key
+                "\x15\x16\x17\x18"s  // key
+                "\x19\x1a\x1b\x1c"s  // key
+                "\x1d\x1e\x1f\x20"s; // key
+            std::string sValue =
+                "This is the value, and it has an arbitrary size."s;
+            auto key = util::convertToBytes(sKey);
+            auto value = util::convertToBytes(sValue);
+
+            auto response = api::Response::success(key, value);
+            api::Message_DHT_SUCCESS message(key, value);
+
+            assert_equal(3ull, response.segments().size(), "Header, key and value are separate segments");
+            assert_equal(message.m_bytes.size(), response.size(), "Size of all segments");
+            assert_true(static_cast<std::vector<uint8_t>>(response) == message.m_bytes, "Same bytes as DHT_SUCCESS");
+
+            return 0;
+        }) ||
+        run_test("API PARSER REJECTS BAD FRAMES", []() {
+            using api::parser::Status;
+            auto parse = [](const std::string &byteString) {
+                auto bytes = util::convertToBytes(byteString);
+                api::parser::Frame frame{};
+                return api::parser::parse(bytes, frame);
+            };
+            std::string key(32, '\x01');
+
+            assert_true(parse("\x00\x24\x02\x8b"s + key) == Status::OK, "GET");
+            assert_true(parse("\x00\x24\x02"s) == Status::INCOMPLETE, "Shorter than a header");
+            assert_true(parse("\x00\x02\x02\x8b"s + key) == Status::BAD_SIZE, "Size smaller than a header");
+            assert_true(parse("\x00\x25\x02\x8b"s + key + "x"s) == Status::BAD_SIZE, "GET with trailing value");
+            assert_true(parse("\x00\x24\x02\x8b"s + key + "x"s) == Status::TRAILING_BYTES, "More bytes than in header");
+            assert_true(parse("\x00\x24\x02\x8b"s + key.substr(1)) == Status::INCOMPLETE, "Fewer bytes than in header");
+            assert_true(parse("\x00\x24\x12\x34"s + key) == Status::UNKNOWN_TYPE, "Unknown type");
+            assert_true(parse("\x00\x10\x02\x8a\x00\x00\x00\x00"s + key.substr(24)) == Status::BAD_SIZE, "PUT without key");
+
+            bool thrown = false;
+            try {
+                auto bytes = util::convertToBytes("\x00\x24\x02\x8d"s + key);
+                api::parser::Frame frame{};
+                assert_true(api::parser::parse(bytes, frame) == Status::OK, "FAILURE");
+                api::Request request(frame);
+            }
+            catch (const api::Request::bad_request &) {
+                thrown = true;
+            }
+            assert_true(thrown, "Request rejects a response");
+
             return 0;
         });
 }
\ No newline at end of file
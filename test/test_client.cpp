@@ -0,0 +1,72 @@
+#include <iostream>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <future>
+#include "assertions.h"
+#include <api.h>
+#include <client.h>
+#include <constants.h>
+
+int main()
+{
+    using namespace std::chrono_literals;
+    using client::Result;
+
+    std::atomic<size_t> stored{0};
+    api::Api server(api::Options{.port= 7950, .threads= 2});
+    // Keys starting with an even byte are found, the value is the key itself.
+    server.on<util::constants::DHT_GET>([](const api::Message_KEY &message_data, auto &) -> api::Response {
+        if (message_data.key[0] % 2 == 0)
+            return api::Response::success(message_data.key, message_data.key);
+        return api::Message_KEY(util::constants::DHT_FAILURE, message_data.key);
+    });
+    server.on<util::constants::DHT_PUT>([&stored](const api::Message_DHT_PUT &, auto &) {
+        ++stored;
+        return api::Response{};
+    });
+
+    return //
+        run_test("CLIENT PIPELINED GET", []() {
+            client::Client dhtClient(client::Options{.port= 7950, .connections= 2, .pipeline= 4});
+
+            std::vector<std::future<Result>> results{};
+            for (size_t i = 0; i < 64; ++i)
+                results.push_back(dhtClient.get(std::vector<uint8_t>(32, static_cast<uint8_t>(i))));
+
+            for (size_t i = 0; i < results.size(); ++i) {
+                auto result = results[i].get();
+                if (i % 2 == 0) {
+                    assert_true(result.status == Result::Status::SUCCESS, "Even key found");
+                    assert_true(result.value == std::vector<uint8_t>(32, static_cast<uint8_t>(i)), "Response matches its request");
+                } else {
+                    assert_true(result.status == Result::Status::FAILURE, "Odd key not found");
+                }
+            }
+            return 0;
+        }) ||
+        run_test("CLIENT PUT", [&stored]() {
+            client::Client dhtClient(client::Options{.port= 7950});
+
+            std::vector<std::promise<bool>> written(16);
+            for (auto &promise: written)
+                dhtClient.put(std::vector<uint8_t>(32, 1), {'v'}, [&promise](bool ok) { promise.set_value(ok); });
+            for (auto &promise: written)
+                assert_true(promise.get_future().get(), "PUT written");
+
+            for (size_t i = 0; i < 100 && stored < written.size(); ++i)
+                std::this_thread::sleep_for(10ms);
+            assert_equal(written.size(), stored.load(), "Every PUT reached the handler");
+
+            bool thrown = false;
+            try {
+                dhtClient.put(std::vector<uint8_t>(31, 1), {});
+            }
+            catch (const std::invalid_argument &) {
+                thrown = true;
+            }
+            assert_true(thrown, "Key of wrong size is rejected");
+            return 0;
+        });
+}
@@ -0,0 +1,46 @@
+#include <chrono>
+#include <thread>
+#include "assertions.h"
+#include <FailureDetector.h>
+
+int main()
+{
+    return run_test("FAILURE DETECTOR", []() {
+        using dht::FailureDetector;
+        using Verdict = FailureDetector::Verdict;
+        using namespace std::chrono_literals;
+
+        FailureDetector detector({.alive_for= 50ms, .dead_after= 3});
+        NodeInformation::Node a{"127.0.0.1", 6001};
+        NodeInformation::Node b{"127.0.0.1", 6002};
+
+        assert_true(detector.verdict(a) == Verdict::UNKNOWN, "never seen");
+        assert_false(detector.rtt(a).has_value());
+
+        detector.success(a, 8ms);
+        assert_true(detector.verdict(a) == Verdict::ALIVE, "answered just now");
+        assert_equal(8000l, detector.rtt(a)->count());
+        detector.success(a, 16ms);
+        assert_equal(9000l, detector.rtt(a)->count(), "rtt is smoothed");
+
+        std::this_thread::sleep_for(60ms);
+        assert_true(detector.verdict(a) == Verdict::UNKNOWN, "alive verdict expires");
+
+        assert_false(detector.failure(a));
+        assert_true(detector.verdict(a) == Verdict::SUSPECT, "one failure");
+        assert_false(detector.failure(a));
+        assert_true(detector.failure(a), "third failure in a row");
+        assert_true(detector.verdict(a) == Verdict::DEAD);
+        assert_false(detector.failure(a), "dead is reported once");
+
+        detector.heard(a);
+        assert_true(detector.verdict(a) == Verdict::ALIVE, "a sign of life revives");
+        assert_equal(9000l, detector.rtt(a)->count(), "heard does not change the rtt");
+
+        detector.failure(b);
+        auto stats = detector.stats();
+        assert_equal(size_t{2}, stats.size());
+        assert_true(stats[0].peer == b && stats[0].failures == 1, "suspect peers first");
+        return 0;
+    });
+}
@@ -0,0 +1,110 @@
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include "assertions.h"
+#include "nodes.h"
+#include <FingerScheduler.h>
+
+namespace
+{
+    /**
+     * @brief Looks up fingers until the scheduler finished one round, the way Dht::fixFingers does.
+     * @return Number of lookups
+     */
+    size_t round(dht::FingerScheduler &scheduler, NodeInformation::RoutingTable &routing,
+                 const std::vector<NodeInformation::Node> &ring)
+    {
+        size_t lookups = 0;
+        size_t last;
+        do {
+            auto index = scheduler.next();
+            auto start = routing.self + util::uint256::pow2(index);
+            auto successor = ring.front();
+            for (const auto &n: ring)
+                if (n.getKey() - start < successor.getKey() - start) successor = n;
+
+            last = scheduler.record(routing, index, successor);
+            for (auto i = index; i <= last; ++i)
+                routing.setFinger(i, successor);
+            routing.rebuild();
+            ++lookups;
+        } while (last != NodeInformation::key_bits - 1);
+        return lookups;
+    }
+}
+
+int main()
+{
+    return run_test("FINGER SCHEDULER", []() {
+        using dht::FingerScheduler;
+        assert_equal(size_t{255}, FingerScheduler::lastCovered(0, util::uint256{}), "whole ring");
+        assert_equal(size_t{3}, FingerScheduler::lastCovered(0, util::uint256::pow2(3) + util::uint256::pow2(1)));
+        assert_equal(size_t{7}, FingerScheduler::lastCovered(7, util::uint256::pow2(3)), "at least the finger itself");
+
+        auto self = node(0x10, 1);
+        auto a = node(0x20, 2);
+        auto b = node(0x90, 3);
+        // Finger 252 covers [0x20.., 0x30..).
+        assert_true(FingerScheduler::isCandidate(self.getKey(), 252, a.getKey(), node(0x28, 4).getKey()));
+        assert_false(FingerScheduler::isCandidate(self.getKey(), 252, a.getKey(), b.getKey()), "past the interval");
+        assert_false(FingerScheduler::isCandidate(self.getKey(), 251, a.getKey(), a.getKey()), "successor outside");
+        NodeInformation::RoutingTable routing{};
+        routing.self = self.getKey();
+
+        FingerScheduler scheduler({.min_interval= std::chrono::milliseconds(100),
+                                   .max_interval= std::chrono::milliseconds(400)});
+        // Fingers [0, 252] all point to a, [253, 255] to b: one lookup each.
+        assert_equal(size_t{2}, round(scheduler, routing, {self, a, b}), "one lookup per distinct interval");
+        assert_true(*routing.fingers[0] == a && *routing.fingers[252] == a, "fingers of a");
+        assert_true(*routing.fingers[253] == b && *routing.fingers[255] == b, "fingers of b");
+        assert_equal(size_t{256}, scheduler.stats().changed_last_round);
+        assert_equal(100l, scheduler.interval().count(), "changed round keeps the minimum interval");
+
+        round(scheduler, routing, {self, a, b});
+        assert_equal(size_t{0}, scheduler.stats().changed_last_round);
+        assert_equal(200l, scheduler.interval().count(), "stable round backs off");
+        round(scheduler, routing, {self, a, b});
+        round(scheduler, routing, {self, a, b});
+        assert_equal(400l, scheduler.interval().count(), "backoff is limited");
+
+        // A finger chosen by proximity from its interval is not a change.
+        auto c = node(0x28, 4);
+        routing.setFinger(252, c);
+        routing.rebuild();
+        round(scheduler, routing, {self, a, b});
+        assert_equal(size_t{0}, scheduler.stats().changed_last_round, "proximity finger");
+
+        scheduler.churn();
+        assert_equal(100l, scheduler.interval().count(), "churn resets the interval");
+
+        // b leaves, its fingers move on to a.
+        assert_equal(size_t{2}, round(scheduler, routing, {self, a}));
+        assert_equal(size_t{3}, scheduler.stats().changed_last_round);
+        assert_true(*routing.fingers[255] == self, "fingers past a wrap around to self");
+        assert_equal(size_t{6}, scheduler.stats().rounds);
+
+        // Base 4 adds 3 * 4^l, base 16 adds the 11 digits of every level that are not powers of two.
+        assert_true(FingerScheduler::digitOffsets(2).empty(), "binary fingers only");
+        auto base4 = FingerScheduler::digitOffsets(4);
+        assert_equal(size_t{128}, base4.size());
+        assert_true(base4[0] == util::uint256::pow2(0) + util::uint256::pow2(1));
+        assert_true(base4[1] == util::uint256::pow2(2) + util::uint256::pow2(3));
+        assert_equal(size_t{64 * 11}, FingerScheduler::digitOffsets(16).size());
+        assert_true(std::is_sorted(base4.begin(), base4.end()), "ascending");
+        bool thrown = false;
+        try {
+            (void) FingerScheduler::digitOffsets(6);
+        }
+        catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert_true(thrown, "base that is not a power of two is rejected");
+
+        assert_equal(size_t{127}, FingerScheduler::lastDigitCovered(base4, 0, util::uint256{}), "whole ring");
+        assert_equal(size_t{1}, FingerScheduler::lastDigitCovered(base4, 0, util::uint256::pow2(4)));
+        assert_equal(size_t{5}, FingerScheduler::lastDigitCovered(base4, 5, util::uint256::pow2(0)),
+                     "at least the finger itself");
+        return 0;
+    });
+}
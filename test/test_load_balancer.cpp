@@ -0,0 +1,83 @@
+#include <chrono>
+#include "assertions.h"
+#include "nodes.h"
+#include <LoadBalancer.h>
+
+namespace
+{
+    util::uint256 key(uint8_t first)
+    {
+        return util::uint256(id(first));
+    }
+}
+
+int main()
+{
+    return run_test("LOAD BALANCER", []() {
+        using namespace std::chrono_literals;
+
+        dht::LoadBalancer balancer({.ratio= 2, .max_bytes= 250});
+        assert_false(balancer.overloaded(0, 0), "no load");
+        assert_true(balancer.overloaded(1, 0));
+        assert_false(balancer.overloaded(200, 100), "within the ratio");
+        assert_true(balancer.overloaded(201, 100));
+
+        // The arc of this node is (0x80, 0x20], it wraps around 0.
+        std::vector<NodeInformation::StoredItem> items{
+            {key(0x10), 100}, {key(0x90), 100}, {key(0xc0), 100}, {key(0xf0), 100}
+        };
+        assert_true(balancer.split(key(0x80), items, 400, 0) == key(0xc0),
+                    "half of the bytes, from the predecessor on");
+        assert_true(balancer.split(key(0x80), items, 400, 200) == key(0x90), "a quarter evens the loads out");
+        assert_false(balancer.split(key(0x80), items, 400, 300).has_value(), "the first item is too large");
+        assert_false(balancer.split(key(0x80), items, 400, 400).has_value(), "not overloaded");
+        assert_false(balancer.split(key(0x80), {}, 400, 0).has_value(), "no items");
+
+        dht::LoadBalancer capped({.ratio= 2, .max_bytes= 150});
+        assert_true(capped.split(key(0x80), items, 400, 0) == key(0x90), "max_bytes bounds a move");
+
+        std::vector<util::uint256> candidates{key(0x70), key(0xa0), key(0xb0), key(0xd0)};
+        assert_true(dht::LoadBalancer::position(key(0x80), key(0xc0), candidates) == 2ul, "furthest before split");
+        assert_false(dht::LoadBalancer::position(key(0x80), key(0x90), candidates).has_value(), "none in range");
+        assert_true(dht::LoadBalancer::position(key(0xc0), key(0x75), candidates) == 0ul, "range wraps around 0");
+
+        // The stored items are those in the arc (predecessor, self], wrapping around 0 or not.
+        NodeInformation info("127.0.0.1", 6001);
+        for (uint8_t i = 0; i < 64; ++i)
+            info.setData({i}, std::vector<uint8_t>(i, 0), std::chrono::hours(1));
+        std::vector<std::vector<uint8_t>> dropped{{0}, {1}, {2}};
+        info.deleteDataAssignedToPredecessor(dropped);
+        assert_equal(size_t{61}, info.getStoredItems().size(), "no predecessor, every item");
+        NodeInformation::id_type lowest{}, highest{};
+        highest.fill(0xff);
+        for (const auto &predecessor: {lowest, highest}) {
+            info.setPredecessor(NodeInformation::Node{"127.0.0.1", 6002, predecessor});
+            auto self = info.getRouting()->self;
+            uint64_t expected = 0, bytes = 0;
+            size_t joining = 0;
+            for (uint8_t i = 3; i < 64; ++i) {
+                auto ringId = util::uint256(util::hash_sha256(std::string(1, static_cast<char>(i))));
+                if (util::is_in_range_loop(ringId, util::uint256(predecessor), self, false, true))
+                    expected += uint64_t{1} + i;
+                if (util::is_in_range_loop(ringId, util::uint256(predecessor), key(0x80), false, true))
+                    ++joining;
+            }
+            for (const auto &item: info.getStoredItems())
+                bytes += item.bytes;
+            assert_true(expected > 0);
+            assert_equal(expected, bytes);
+            assert_equal(joining, info.getDataItemsForNodeId(node(0x80, 6003))->size(), "items of a joining node");
+        }
+
+        auto start = dht::RequestRate::clock_type::now();
+        dht::RequestRate rate(10s, start);
+        rate.add(start);
+        rate.add(start + 5s);
+        assert_equal(uint64_t{0}, rate.rate(start + 9s), "first window not complete");
+        rate.add(start + 12s);
+        assert_equal(uint64_t{2}, rate.rate(start + 15s));
+        assert_equal(uint64_t{1}, rate.rate(start + 21s));
+        assert_equal(uint64_t{0}, rate.rate(start + 45s), "idle windows in between");
+        return 0;
+    });
+}
@@ -0,0 +1,50 @@
+#include "assertions.h"
+#include "nodes.h"
+#include <LookupCache.h>
+
+int main()
+{
+    return run_test("LOOKUP CACHE", []() {
+        dht::LookupCache cache(2);
+        auto a = node(0x40, 1);
+        auto b = node(0x80, 2);
+        auto c = node(0x10, 3);
+
+        assert_false(cache.find(id(0x30)).has_value(), "empty");
+        cache.insert(id(0x30), a);
+        assert_true(cache.find(id(0x30)) == a);
+        assert_true(cache.find(id(0x40)) == a, "the node's own id");
+        assert_false(cache.find(id(0x20)).has_value(), "before the known range");
+        cache.insert(id(0x20), a);
+        assert_true(cache.find(id(0x28)) == a, "range extended back");
+
+        // The range of c wraps around 0.
+        cache.insert(id(0xf0), c);
+        assert_true(cache.find(id(0x05)) == c);
+        assert_true(cache.find(id(0xf8)) == c);
+        assert_false(cache.find(id(0xe0)).has_value());
+
+        // a was used last, c is evicted.
+        cache.find(id(0x30));
+        cache.insert(id(0x70), b);
+        assert_false(cache.find(id(0x05)).has_value(), "least recently used is evicted");
+        assert_true(cache.find(id(0x30)) == a);
+
+        // A lookup of 0x30 returned b: a is gone.
+        cache.insert(id(0x30), b);
+        assert_true(cache.find(id(0x40)) == b, "node inside a new range is dropped");
+
+        cache.invalidate(b);
+        assert_false(cache.find(id(0x40)).has_value(), "invalidated");
+
+        auto stats = cache.stats();
+        assert_equal(size_t{0}, stats.size);
+        assert_equal(uint64_t{2}, stats.invalidations);
+        assert_equal(uint64_t{8}, stats.hits);
+
+        dht::LookupCache disabled(0);
+        disabled.insert(id(0x30), a);
+        assert_false(disabled.find(id(0x30)).has_value(), "capacity 0 disables the cache");
+        return 0;
+    });
+}
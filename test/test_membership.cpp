@@ -0,0 +1,55 @@
+#include <chrono>
+#include <thread>
+#include "assertions.h"
+#include "nodes.h"
+#include <Membership.h>
+
+int main()
+{
+    return run_test("MEMBERSHIP", []() {
+        using dht::Membership;
+        using namespace std::chrono_literals;
+
+        auto self = node(0x10, 1);
+        auto a = node(0x40, 2);
+        auto b = node(0x80, 3);
+        Membership membership(self, 5, {.gossip_size= 3, .retransmit_factor= 1, .tombstone_for= 50ms});
+
+        assert_true(membership.successor(id(0x50)) == self, "alone, responsible for everything");
+        membership.merge({{a, true, 1}, {b, true, 1}});
+        assert_equal(size_t{3}, membership.size());
+        assert_true(membership.successor(id(0x20)) == a);
+        assert_true(membership.successor(id(0x40)) == a, "a node's own id");
+        assert_true(membership.successor(id(0x90)) == self, "wraps around");
+
+        // The sender's own entry first, then the changes.
+        auto gossip = membership.gossip();
+        assert_equal(size_t{3}, gossip.size());
+        assert_true(gossip[0].node == self && gossip[0].incarnation == 5);
+
+        membership.dead(a);
+        assert_true(membership.successor(id(0x20)) == b, "dead members are skipped");
+        membership.merge({{a, true, 1}});
+        assert_true(membership.successor(id(0x20)) == b, "older gossip does not bring a back");
+        membership.merge({{a, true, 2}});
+        assert_true(membership.successor(id(0x20)) == a, "a refuted with a new incarnation");
+
+        membership.merge({{self, false, 5}});
+        assert_equal(uint64_t{6}, membership.gossip()[0].incarnation, "refutes its own death");
+
+        membership.merge({{b, false, 1}});
+        assert_equal(size_t{2}, membership.size());
+        std::this_thread::sleep_for(60ms);
+        membership.gossip();
+        assert_equal(size_t{2}, membership.members().size(), "tombstone dropped");
+
+        // Members that did not change are still gossiped, round robin.
+        Membership quiet(self, 1, {.gossip_size= 2, .retransmit_factor= 0});
+        quiet.merge({{a, true, 1}, {b, true, 1}});
+        auto first = quiet.gossip();
+        auto second = quiet.gossip();
+        assert_equal(size_t{2}, first.size());
+        assert_true(first[1].node != second[1].node, "round robin");
+        return 0;
+    });
+}
@@ -0,0 +1,42 @@
+#include <capnp/message.h>
+#include <kj/exception.h>
+#include "assertions.h"
+#include <Peer.h>
+
+int main()
+{
+    return run_test("NODE WIRE", []() {
+        using dht::PeerImpl;
+
+        NodeInformation::Node host{"127.0.0.1", 6002};
+        NodeInformation::Node vnode{"127.0.0.1", 6002, 3};
+        assert_equal(uint16_t{0}, host.getVnode());
+        assert_false(host == vnode, "a vnode has an id of its own");
+        assert_true(NodeInformation::Node("127.0.0.1", 6002, 0) == host, "vnode 0 is the host");
+
+        capnp::MallocMessageBuilder message;
+        auto builder = message.initRoot<dht::Node>();
+        PeerImpl::buildNode(builder, vnode);
+        auto decoded = PeerImpl::nodeFromReader(builder.asReader());
+        assert_equal(uint16_t{3}, decoded.getVnode());
+        assert_true(decoded == vnode, "same id after the round trip");
+
+        // The way getPredecessor and getClosestPreceding answer.
+        capnp::MallocMessageBuilder optionalMessage;
+        auto optional = optionalMessage.initRoot<dht::Optional<dht::Node>>();
+        PeerImpl::buildNode(optional, std::make_shared<const NodeInformation::Node>(vnode));
+        assert_true(PeerImpl::nodeFromReader(optional.asReader()) == vnode);
+        PeerImpl::buildNode(optional, NodeInformation::node_handle{});
+        assert_false(PeerImpl::nodeFromReader(optional.asReader()).has_value(), "empty handle");
+
+        builder.setVnode(NodeInformation::max_vnodes);
+        bool thrown = false;
+        try {
+            static_cast<void>(PeerImpl::nodeFromReader(builder.asReader()));
+        } catch (const kj::Exception &) {
+            thrown = true;
+        }
+        assert_true(thrown, "vnode out of range");
+        return 0;
+    });
+}
@@ -40,6 +40,55 @@ int main()
             std::array<uint8_t, 4>{3, 0, 0, 0},
             "array addition 2");
 
+        assert_true(
+            std::array<uint8_t, 4>{2, 4, 6, 8} -
+            std::array<uint8_t, 4>{1, 2, 3, 4} ==
+            std::array<uint8_t, 4>{1, 2, 3, 4},
+            "array subtraction 1");
+
+        assert_true(
+            std::array<uint8_t, 4>{3, 0, 0, 0} -
+            std::array<uint8_t, 4>{1, 1, 0, 128} ==
+            std::array<uint8_t, 4>{1, 254, 255, 128},
+            "array subtraction 2");
+
+        assert_true(
+            std::array<uint8_t, 4>{0, 0, 0, 1} -
+            std::array<uint8_t, 4>{0, 0, 0, 2} ==
+            std::array<uint8_t, 4>{255, 255, 255, 255},
+            "array subtraction wraps around");
+
+        return 0;
+    }) || run_test("UINT256", []() {
+        std::array<uint8_t, 32> bytes{};
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = static_cast<uint8_t>(i + 1);
+        util::uint256 value(bytes);
+        assert_equal(0x0102030405060708ull, value.words[0], "big endian words");
+        assert_true(value.bytes() == bytes, "bytes round trip");
+
+        util::uint256 max{};
+        max.words = {~0ull, ~0ull, ~0ull, ~0ull};
+        assert_true((max + util::uint256::pow2(0)).is_zero(), "addition wraps around");
+        assert_true(util::uint256{} - util::uint256::pow2(0) == max, "subtraction wraps around");
+        assert_true(util::uint256::pow2(63) + util::uint256::pow2(63) == util::uint256::pow2(64), "carry into next word");
+        assert_true(util::uint256::pow2(64) - util::uint256::pow2(0) == util::uint256::pow2(64) - util::uint256::pow2(1) + util::uint256::pow2(0), "borrow from next word");
+        assert_true(util::uint256::pow2(256).is_zero(), "pow2 out of range");
+        assert_equal(size_t{0}, util::uint256{}.bit_width(), "bit width of zero");
+        assert_equal(size_t{1}, util::uint256::pow2(0).bit_width(), "bit width of one");
+        assert_equal(size_t{201}, (util::uint256::pow2(200) + util::uint256::pow2(3)).bit_width(), "bit width");
+        assert_equal(size_t{256}, max.bit_width(), "bit width of max");
+
+        // Same results as the byte-wise operations.
+        auto a = util::hash_sha256(std::string("a"));
+        auto b = util::hash_sha256(std::string("b"));
+        assert_true((util::uint256(a) + util::uint256(b)).bytes() == a + b, "same sum as bytes");
+        assert_true((util::uint256(a) - util::uint256(b)).bytes() == a - b, "same difference as bytes");
+        assert_true((util::uint256(a) < util::uint256(b)) == (a < b), "same order as bytes");
+        assert_true((util::uint256(bytes) + util::uint256::pow2(200)).bytes() == bytes + util::pow2<uint8_t, 32>(200), "same finger start");
+        assert_true(util::is_in_range_loop(util::uint256(a), util::uint256(b), util::uint256(b)) ==
+                    util::is_in_range_loop(a, b, b), "same range check");
+
         return 0;
     });
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include <chrono>
+#include <thread>
+#include "assertions.h"
+#include <ValueCache.h>
+
+int main()
+{
+    return run_test("VALUE CACHE", []() {
+        using dht::ValueCache;
+        using namespace std::chrono_literals;
+
+        ValueCache cache({.capacity= 2, .max_staleness= 50ms});
+        auto now = ValueCache::clock_type::now();
+        auto never = ValueCache::clock_type::time_point::max();
+        ValueCache::key_type a{1}, b{2}, c{3};
+        ValueCache::value_type value{42};
+
+        assert_false(cache.find(a).has_value(), "empty");
+        cache.insert(a, value, never);
+        assert_true(cache.find(a) == value);
+
+        cache.insert(b, value, now - 1s);
+        assert_false(cache.find(b).has_value(), "already expired");
+
+        cache.insert(b, value, never);
+        cache.find(a);
+        cache.insert(c, value, never);
+        assert_false(cache.find(b).has_value(), "least recently used is evicted");
+        assert_true(cache.find(a).has_value());
+
+        cache.erase(a);
+        assert_false(cache.find(a).has_value(), "erased");
+
+        cache.insert(a, value, ValueCache::clock_type::now() + 20ms);
+        std::this_thread::sleep_for(30ms);
+        assert_false(cache.find(a).has_value(), "expires with the item");
+        assert_true(cache.find(c).has_value(), "within max staleness");
+        std::this_thread::sleep_for(30ms);
+        assert_false(cache.find(c).has_value(), "max staleness exceeded");
+
+        auto stats = cache.stats();
+        assert_equal(size_t{0}, stats.size);
+        assert_equal(uint64_t{4}, stats.hits);
+        assert_equal(uint64_t{6}, stats.misses);
+
+        ValueCache disabled({.capacity= 0});
+        disabled.insert(a, value, never);
+        assert_false(disabled.find(a).has_value(), "capacity 0 disables the cache");
+        return 0;
+    });
+}